@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// A minimal timing harness for the benchmarks. Every benchmark is run a few times and the fastest
+// run is reported, which filters out most of the noise of the other processes of the machine.
+
+static constexpr int kNumBenchmarkRuns = 5;
+
+// Results are added to this, so that the compiler cannot remove the work being measured.
+extern volatile uint64_t g_benchmark_sink;
+
+// Returns the time, in seconds, of the fastest of a few calls to fn.
+template<typename Fn>
+inline double
+MeasureBestSeconds(Fn&& fn)
+{
+    double best = 0.0;
+    for (int run = 0; run < kNumBenchmarkRuns; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        if (run == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+// Prints how many millions of items (lookups, bytes...) were processed per second.
+inline void
+PrintRate(const char* name, double num_items, double seconds, const char* unit)
+{
+    printf("%-48s %10.2f %s\n", name, num_items / seconds / 1e6, unit);
+}
+
+// The benchmarks of each file. They print one line per measure.
+void RunSidBenchmarks();
+void RunHashMapBenchmarks();
+void RunHashBenchmarks();
+void RunJsonBenchmarks();
@@ -0,0 +1,69 @@
+#include "Han/Hash.hpp"
+#include "Benchmark.hpp"
+#include <string.h>
+
+// The string hash that Sids and the String maps used before HashString: djb2, one byte at a time
+// up to the null terminator.
+static uint64_t
+HashDjb2(const char* str)
+{
+    uint64_t hash = 5381;
+    int c = 0;
+    while ((c = *str++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash;
+}
+
+// Enough bytes per measure for the timer to be precise, whatever the length of the strings.
+static constexpr size_t kBytesPerRun = (size_t)1 << 28;
+
+void
+RunHashBenchmarks()
+{
+    // Short names like uniforms, resource paths, and longer strings.
+    static const size_t kLengths[] = {8, 16, 32, 64, 256};
+
+    // Several strings of each length, so that the loop does not hash the same bytes every time.
+    static constexpr size_t kNumStrings = 64;
+    char strings[kNumStrings][257];
+    for (size_t i = 0; i < kNumStrings; ++i) {
+        for (size_t c = 0; c < 256; ++c) {
+            strings[i][c] = (char)('a' + (i * 7 + c * 13) % 26);
+        }
+    }
+
+    for (size_t len : kLengths) {
+        for (size_t i = 0; i < kNumStrings; ++i) {
+            strings[i][len] = '\0';
+        }
+
+        const size_t num_hashes = kBytesPerRun / len;
+        char name[64];
+
+        double seconds = MeasureBestSeconds([&]() {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < num_hashes; ++i) {
+                sum += HashString(strings[i % kNumStrings], len);
+            }
+            g_benchmark_sink += sum;
+        });
+        snprintf(name, sizeof(name), "HashString, %zu bytes", len);
+        PrintRate(name, (double)num_hashes * len, seconds, "MB/s");
+
+        seconds = MeasureBestSeconds([&]() {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < num_hashes; ++i) {
+                sum += HashDjb2(strings[i % kNumStrings]);
+            }
+            g_benchmark_sink += sum;
+        });
+        snprintf(name, sizeof(name), "djb2, %zu bytes", len);
+        PrintRate(name, (double)num_hashes * len, seconds, "MB/s");
+
+        // Back to the full length for the next size.
+        for (size_t i = 0; i < kNumStrings; ++i) {
+            strings[i][len] = (char)('a' + (i * 7 + len * 13) % 26);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "Han/Collections/Array.hpp"
+#include "Han/Collections/FlatHashMap.hpp"
+#include "Han/Collections/RobinHashMap.hpp"
+#include "Han/Collections/String.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Han/Sid.hpp"
+#include "Benchmark.hpp"
+
+// FlatHashMap and RobinHashMap side by side, for the key types the engine uses. The maps hold
+// kNumKeys elements, a bit more than the Sid database, and the lookups cycle through every key so
+// that the whole table is touched.
+
+static constexpr size_t kNumKeys = 4096;
+static constexpr size_t kNumLookups = 1 << 23;
+
+static void
+MakeKeys(Allocator* allocator, const char* prefix, Array<Sid>* out_keys)
+{
+    (void)allocator;
+    char name[64];
+    for (size_t i = 0; i < kNumKeys; ++i) {
+        snprintf(name, sizeof(name), "%s_%zu", prefix, i);
+        out_keys->PushBack(SID(name));
+    }
+}
+
+static void
+MakeKeys(Allocator* allocator, const char* prefix, Array<uint64_t>* out_keys)
+{
+    (void)allocator;
+    // Spread like the hashes of the Sid database.
+    for (size_t i = 0; i < kNumKeys; ++i) {
+        out_keys->PushBack(MakeStringHash(prefix) ^ (i * 0x9e3779b97f4a7c15ull));
+    }
+}
+
+static void
+MakeKeys(Allocator* allocator, const char* prefix, Array<String>* out_keys)
+{
+    // Names the length of resource paths.
+    char name[64];
+    for (size_t i = 0; i < kNumKeys; ++i) {
+        snprintf(name, sizeof(name), "resources/%s/texture_%zu.png", prefix, i);
+        out_keys->PushBack(String(allocator, name));
+    }
+}
+
+template<typename Map, typename Key>
+static uint64_t
+LookUpAll(const Map& map, const Array<Key>& keys, bool count_hits)
+{
+    uint64_t sum = 0;
+    size_t key_index = 0;
+    for (size_t i = 0; i < kNumLookups; ++i) {
+        const uint32_t* val = map.Find(keys[key_index]);
+        sum += count_hits ? (val != nullptr) : *val;
+        key_index = key_index + 1 < keys.len ? key_index + 1 : 0;
+    }
+    return sum;
+}
+
+template<typename Map, typename Key>
+static void
+BenchmarkMap(const char* map_name, const char* key_name, const Array<Key>& keys, const Array<Key>& missing_keys)
+{
+    Map map(MallocAllocator::Instance(), kNumKeys);
+    for (size_t i = 0; i < keys.len; ++i) {
+        map.Add(keys[i], (uint32_t)i);
+    }
+
+    char name[64];
+    double seconds = MeasureBestSeconds([&]() { g_benchmark_sink += LookUpAll(map, keys, false); });
+    snprintf(name, sizeof(name), "%s<%s> lookup, hit", map_name, key_name);
+    PrintRate(name, kNumLookups, seconds, "M lookups/s");
+
+    seconds = MeasureBestSeconds([&]() { g_benchmark_sink += LookUpAll(map, missing_keys, true); });
+    snprintf(name, sizeof(name), "%s<%s> lookup, miss", map_name, key_name);
+    PrintRate(name, kNumLookups, seconds, "M lookups/s");
+}
+
+template<typename Key>
+static void
+BenchmarkKey(const char* key_name)
+{
+    Allocator* allocator = MallocAllocator::Instance();
+    Array<Key> keys(allocator);
+    Array<Key> missing_keys(allocator);
+    MakeKeys(allocator, "present", &keys);
+    MakeKeys(allocator, "missing", &missing_keys);
+
+    BenchmarkMap<RobinHashMap<Key, uint32_t>>("RobinHashMap", key_name, keys, missing_keys);
+    BenchmarkMap<FlatHashMap<Key, uint32_t>>("FlatHashMap", key_name, keys, missing_keys);
+}
+
+void
+RunHashMapBenchmarks()
+{
+    BenchmarkKey<Sid>("Sid");
+    BenchmarkKey<uint64_t>("uint64_t");
+    BenchmarkKey<String>("String");
+}
@@ -0,0 +1,87 @@
+#include "Han/Collections/Array.hpp"
+#include "Han/Json.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Benchmark.hpp"
+#include <stdio.h>
+
+#ifndef HAN_BENCHMARK_RESOURCES_PATH
+#define HAN_BENCHMARK_RESOURCES_PATH "resources"
+#endif
+
+// The gltf files are only a few kilobytes, each measure parses them again and again until about
+// this many bytes went through the parser.
+static constexpr size_t kBytesPerRun = (size_t)1 << 26;
+
+static bool
+ReadFile(const char* path, Array<uint8_t>* out_data)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t read = 0;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out_data->Append(buffer, read);
+    }
+    fclose(file);
+    return true;
+}
+
+static void
+BenchmarkFile(const char* file_name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", HAN_BENCHMARK_RESOURCES_PATH, file_name);
+
+    Array<uint8_t> data(MallocAllocator::Instance());
+    if (!ReadFile(path, &data) || data.len == 0) {
+        printf("Could not read %s, skipping it\n", path);
+        return;
+    }
+
+    {
+        Json::Document doc(MallocAllocator::Instance());
+        doc.ParseInSitu(data.data, data.len);
+        if (doc.HasParseErrors()) {
+            printf("Could not parse %s: %s\n", path, doc.GetErrorStr());
+            return;
+        }
+    }
+
+    const size_t num_parses = kBytesPerRun / data.len + 1;
+    char name[64];
+
+    // Like the gltf importer: the text stays alive while the document is used.
+    double seconds = MeasureBestSeconds([&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < num_parses; ++i) {
+            Json::Document doc(MallocAllocator::Instance());
+            doc.ParseInSitu(data.data, data.len);
+            sum += (uint64_t)doc.root_val.type;
+        }
+        g_benchmark_sink += sum;
+    });
+    snprintf(name, sizeof(name), "Json ParseInSitu, %s", file_name);
+    PrintRate(name, (double)num_parses * data.len, seconds, "MB/s");
+
+    seconds = MeasureBestSeconds([&]() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < num_parses; ++i) {
+            Json::Document doc(MallocAllocator::Instance());
+            doc.Parse(data.data, data.len);
+            sum += (uint64_t)doc.root_val.type;
+        }
+        g_benchmark_sink += sum;
+    });
+    snprintf(name, sizeof(name), "Json Parse, %s", file_name);
+    PrintRate(name, (double)num_parses * data.len, seconds, "MB/s");
+}
+
+void
+RunJsonBenchmarks()
+{
+    BenchmarkFile("hammer.gltf");
+    BenchmarkFile("Alpine_chalet.gltf");
+}
@@ -0,0 +1,27 @@
+#include "Han/MallocAllocator.hpp"
+#include "Han/Sid.hpp"
+#include "Benchmark.hpp"
+
+volatile uint64_t g_benchmark_sink = 0;
+
+int main(int argc, char** argv)
+{
+    // unused args
+    (void)argc;
+    (void)argv;
+
+#if HAN_SID_DATABASE
+    // Sids made with SID() register their string, like in the engine.
+    SidDatabase::Initialize(MallocAllocator::Instance());
+#endif
+
+    RunSidBenchmarks();
+    RunHashMapBenchmarks();
+    RunHashBenchmarks();
+    RunJsonBenchmarks();
+
+#if HAN_SID_DATABASE
+    SidDatabase::Terminate();
+#endif
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "Han/Collections/Array.hpp"
+#include "Han/Collections/RobinHashMap.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Han/Sid.hpp"
+#include "Benchmark.hpp"
+
+// The uniforms that the shaders look up, and that the materials store their values under.
+static const Sid kUniformNames[] = {
+    "u_model"_sid,
+    "u_view"_sid,
+    "u_projection"_sid,
+    "u_view_projection"_sid,
+    "u_camera_position"_sid,
+    "u_light_position"_sid,
+    "u_light_color"_sid,
+    "u_flat_color"_sid,
+    "u_input_texture"_sid,
+    "u_albedo_texture"_sid,
+    "u_normal_texture"_sid,
+    "u_occlusion_texture"_sid,
+    "u_metallic_roughness_texture"_sid,
+    "u_metallic_factor"_sid,
+    "u_roughness_factor"_sid,
+};
+
+static constexpr size_t kNumUniformNames = sizeof(kUniformNames) / sizeof(kUniformNames[0]);
+static constexpr size_t kNumLookups = 1 << 24;
+
+// Looks up every key in turn until kNumLookups lookups are done, and returns the sum of the values
+// found (or the number of keys found when count_hits is true).
+template<typename Map>
+static uint64_t
+LookUpAll(const Map& map, const Sid* keys, size_t num_keys, bool count_hits)
+{
+    uint64_t sum = 0;
+    size_t key_index = 0;
+    for (size_t i = 0; i < kNumLookups; ++i) {
+        const int* val = map.Find(keys[key_index]);
+        sum += count_hits ? (val != nullptr) : *val;
+        key_index = key_index + 1 < num_keys ? key_index + 1 : 0;
+    }
+    return sum;
+}
+
+void
+RunSidBenchmarks()
+{
+    Allocator* allocator = MallocAllocator::Instance();
+
+    // Sized like Shader::location_cache.
+    RobinHashMap<Sid, int> locations(allocator, 16);
+    for (size_t i = 0; i < kNumUniformNames; ++i) {
+        locations.Add(kUniformNames[i], (int)i);
+    }
+
+    double seconds = MeasureBestSeconds([&]() {
+        g_benchmark_sink += LookUpAll(locations, kUniformNames, kNumUniformNames, false);
+    });
+    PrintRate("RobinHashMap<Sid> uniform lookup, hit", kNumLookups, seconds, "M lookups/s");
+
+    // Sids of resources, made at runtime with SID() like the materials and meshes, and looked up
+    // in a map as big as the Sid database.
+    char name[32];
+    Array<Sid> resource_names(allocator);
+    RobinHashMap<Sid, int> resources(allocator, SidDatabase::kDatabaseSize);
+    for (int i = 0; i < SidDatabase::kDatabaseSize; ++i) {
+        snprintf(name, sizeof(name), "material_%d", i);
+        resource_names.PushBack(SID(name));
+        resources.Add(resource_names[i], i);
+    }
+
+    seconds = MeasureBestSeconds([&]() {
+        g_benchmark_sink += LookUpAll(resources, resource_names.data, resource_names.len, false);
+    });
+    PrintRate("RobinHashMap<Sid> 2048 resources lookup, hit", kNumLookups, seconds, "M lookups/s");
+
+    // The uniforms are never in the resources map.
+    seconds = MeasureBestSeconds([&]() {
+        g_benchmark_sink += LookUpAll(resources, kUniformNames, kNumUniformNames, true);
+    });
+    PrintRate("RobinHashMap<Sid> 2048 resources lookup, miss", kNumLookups, seconds, "M lookups/s");
+}
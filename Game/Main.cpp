@@ -6,7 +6,7 @@
 //
 
 static TriangleMesh
-SetupPlane(Allocator* allocator, Allocator* scratch_allocator, Material* material)
+SetupPlane(Allocator* allocator, Allocator* scratch_allocator, MaterialHandle material)
 {
     // clang-format off
     static const uint32_t indices[] =
@@ -86,9 +86,9 @@ SetupPlane(Allocator* allocator, Allocator* scratch_allocator, Material* materia
 
 // TODO: receive a texture catalog
 static TriangleMesh
-SetupCube(Allocator* allocator, Allocator* scratch_allocator, Material* material)
+SetupCube(Allocator* allocator, Allocator* scratch_allocator, MaterialHandle material)
 {
-    ASSERT(material, "material should exist");
+    ASSERT(material.IsValid(), "material should exist");
     ASSERT(allocator, "allocator should exist");
     ASSERT(scratch_allocator, "scratch allocator should exist");
     // clang-format off
@@ -261,14 +261,14 @@ public:
 
 		ResourceManager* resource_manager = Application::Instance()->GetResourceManager();
 
-		resource_manager->LoadShader(SID("flat_color.glsl"));
+		resource_manager->LoadShader("flat_color.glsl");
 		_flat_color_shader = resource_manager->GetShader(SID("flat_color.glsl"));
 		assert(_flat_color_shader && _flat_color_shader->IsValid() && "program should be valid");
 		_flat_color_shader->AddUniform("u_model");
 		_flat_color_shader->AddUniform("u_view_projection");
 		_flat_color_shader->AddUniform("u_flat_color");
 
-		resource_manager->LoadShader(SID("basic.glsl"));
+		resource_manager->LoadShader("basic.glsl");
 		_basic_shader = resource_manager->GetShader(SID("basic.glsl"));
 		assert(_basic_shader && _basic_shader->IsValid() && "program should be valid");
 		_basic_shader->AddUniform("u_model");
@@ -276,7 +276,7 @@ public:
 		_basic_shader->AddUniform("u_projection");
 		_basic_shader->AddUniform("u_input_texture");
 
-		resource_manager->LoadShader(SID("gltf.glsl"));
+		resource_manager->LoadShader("gltf.glsl");
 		_gltf_shader = resource_manager->GetShader(SID("gltf.glsl"));
 		assert(_gltf_shader && _gltf_shader->IsValid() && "program should be valid");
 		_gltf_shader->AddUniform("u_model");
@@ -284,7 +284,7 @@ public:
 		_gltf_shader->AddUniform("u_projection");
 		_gltf_shader->AddUniform("u_input_texture");
 
-		resource_manager->LoadShader(SID("pbr.glsl"));
+		resource_manager->LoadShader("pbr.glsl");
 		_pbr_shader = resource_manager->GetShader(SID("pbr.glsl"));
 		assert(_pbr_shader && _pbr_shader->IsValid() && "program should be valid");
 		_pbr_shader->AddUniform("u_model");
@@ -300,50 +300,41 @@ public:
 		_pbr_shader->AddUniform("u_roughness_factor");
 
 		_basic_shader->Bind();
-		_basic_shader->SetUniformMat4(SID("u_projection"), _camera.projection_matrix);
+		_basic_shader->SetUniformMat4("u_projection"_sid, _camera.projection_matrix);
 
 		_gltf_shader->Bind();
-		_gltf_shader->SetUniformMat4(SID("u_projection"), _camera.projection_matrix);
+		_gltf_shader->SetUniformMat4("u_projection"_sid, _camera.projection_matrix);
 
 		//------------------------------
 		// Create the texture catalog and textures
 		//------------------------------
-		resource_manager->LoadTexture(SID("wall.jpg"), LoadTextureFlags_FlipVertically|LoadTextureFlags_LinearSpace);
+		TextureHandle wall_texture = resource_manager->LoadTexture("wall.jpg", LoadTextureFlags_FlipVertically|LoadTextureFlags_LinearSpace);
 
-		Texture* wall_texture = resource_manager->GetTexture(SID("wall.jpg"));
-		LOG_DEBUG("Loaded texture named: %s", wall_texture->name.GetStr());
-		LOG_DEBUG("       width: %d", wall_texture->width);
-		LOG_DEBUG("       height: %d", wall_texture->height);
-
-		// HACK: load this material from a file instead of doing it like this
 		{
-			Material* material = resource_manager->allocator->New<Material>(resource_manager->allocator);
-			material->name = SID("wall");
-			material->shader = _basic_shader;
-			material->AddValue(SID("u_input_texture"), MaterialValue(wall_texture));
-			resource_manager->materials.Add(material->name, material);
+			const Texture* texture = resource_manager->GetTexture(wall_texture);
+			LOG_DEBUG("Loaded texture named: %s", texture->name.GetStrOr("<unknown>"));
+			LOG_DEBUG("       width: %d", texture->width);
+			LOG_DEBUG("       height: %d", texture->height);
+			(void)texture;
 		}
 
+		// HACK: load this material from a file instead of doing it like this
+		MaterialHandle wall_material = resource_manager->CreateMaterial(SID("wall"), _basic_shader);
+		resource_manager->GetMaterial(wall_material)->AddValue("u_input_texture"_sid, MaterialValue(wall_texture));
+
 		// DEBUG meshes for testing
-		Material* wall_material = resource_manager->GetMaterial(SID("wall"));
-		assert(wall_material);
 		_floor_mesh = SetupPlane(main_allocator, temp_allocator, wall_material);
 		_cube_mesh = SetupCube(main_allocator, temp_allocator, wall_material);
 
-		{
-			Material* material = resource_manager->allocator->New<Material>(resource_manager->allocator);
-			material->name = SID("flat_color");
-			material->shader = _flat_color_shader;
-			material->AddValue(SID("u_flat_color"), MaterialValue(Vec4(1.0f)));
-			resource_manager->materials.Add(material->name, material);
-		}
+		MaterialHandle flat_color_material = resource_manager->CreateMaterial(SID("flat_color"), _flat_color_shader);
+		resource_manager->GetMaterial(flat_color_material)->AddValue("u_flat_color"_sid, MaterialValue(Vec4(1.0f)));
 
-		_light_mesh = SetupCube(main_allocator, temp_allocator, resource_manager->GetMaterial(SID("flat_color")));
+		_light_mesh = SetupCube(main_allocator, temp_allocator, flat_color_material);
 
-		_alpine_chalet = resource_manager->LoadModel(SID("Alpine_chalet.model"));
-		_hammer = resource_manager->LoadModel(SID("hammer.model"));
-		_nanosuit = resource_manager->LoadModel(SID("nanosuit.model"));
-		_box_animated = resource_manager->LoadModel(SID("BoxAnimated.model"));
+		_alpine_chalet = resource_manager->LoadModel("Alpine_chalet.model");
+		_hammer = resource_manager->LoadModel("hammer.model");
+		_nanosuit = resource_manager->LoadModel("nanosuit.model");
+		_box_animated = resource_manager->LoadModel("BoxAnimated.model");
 
 		LOG_DEBUG("Starting main loop");
 		Graphics::LowLevelApi::SetClearColor(Vec4(0.2f, 0.2f, 0.2f, 1.0f));
@@ -392,47 +383,48 @@ public:
 
         auto view_matrix = _camera.GetViewMatrix();
         auto view_projection_matrix = _camera.GetViewProjectionMatrix(view_matrix);
+        const ResourceManager& resources = *Application::Instance()->GetResourceManager();
 
         _basic_shader->Bind();
-        _basic_shader->SetUniformMat4(SID("u_view"), view_matrix);
+        _basic_shader->SetUniformMat4("u_view"_sid, view_matrix);
 
         // TODO: add real values here for the parameters
         Vec3 cube_position(10.0f, 0.0f, 0.0f);
         Quaternion cube_orientation =
             Quaternion::Rotation(Math::DegreesToRadians(ticks * 0.035f), Vec3(0, 1, 0));
         float cube_scale = 1.0f;
-        RenderMesh(_cube_mesh, *_basic_shader, cube_position, cube_orientation, cube_scale);
+        RenderMesh(_cube_mesh, resources, *_basic_shader, cube_position, cube_orientation, cube_scale);
 
         Vec3 floor_position(0, -5, 3);
         Quaternion floor_orientation =
             Quaternion::Rotation(Math::DegreesToRadians(90), Vec3(-1, 0, 0));
         float floor_scale = 50.0f;
-        RenderMesh(_floor_mesh, *_basic_shader, floor_position, floor_orientation, floor_scale);
+        RenderMesh(_floor_mesh, resources, *_basic_shader, floor_position, floor_orientation, floor_scale);
 
         Vec3 nanosuit_position(-10, 0, 0);
         Quaternion nanosuit_orientation = Quaternion::Identity();
         assert(_nanosuit.meshes.len == 1);
-        RenderMesh(*_nanosuit.meshes[0], *_basic_shader, nanosuit_position, nanosuit_orientation, 1.0f);
+        RenderMesh(*resources.GetMesh(_nanosuit.meshes[0]), resources, *_basic_shader, nanosuit_position, nanosuit_orientation, 1.0f);
 
         Vec3 light_position(0.0f, 10.0f, 10.0f);
         _flat_color_shader->Bind();
-        _flat_color_shader->SetUniformMat4(SID("u_view_projection"), view_projection_matrix);
-        RenderMesh(_light_mesh, *_flat_color_shader, light_position, Quaternion::Identity(), 0.4f);
+        _flat_color_shader->SetUniformMat4("u_view_projection"_sid, view_projection_matrix);
+        RenderMesh(_light_mesh, resources, *_flat_color_shader, light_position, Quaternion::Identity(), 0.4f);
 
         _gltf_shader->Bind();
-        _gltf_shader->SetUniformMat4(SID("u_view"), _camera.GetViewMatrix());
+        _gltf_shader->SetUniformMat4("u_view"_sid, _camera.GetViewMatrix());
 
         _pbr_shader->Bind();
-        _pbr_shader->SetUniformMat4(SID("u_view_projection"), view_projection_matrix);
-        _pbr_shader->SetVector(SID("u_camera_position"), _camera.position);
-        _pbr_shader->SetVector(SID("u_light_position"), light_position);
-        _pbr_shader->SetVector(SID("u_light_color"), Vec3(1.0f));
+        _pbr_shader->SetUniformMat4("u_view_projection"_sid, view_projection_matrix);
+        _pbr_shader->SetVector("u_camera_position"_sid, _camera.position);
+        _pbr_shader->SetVector("u_light_position"_sid, light_position);
+        _pbr_shader->SetVector("u_light_color"_sid, Vec3(1.0f));
         //RenderModel(alpine_chalet, *gltf_shader, Vec3::Zero(), Quaternion::Identity(), 1.0f);
         auto hammer_rotation = Quaternion::Rotation(Math::DegreesToRadians(90), Vec3(1, 0, 0));
         //auto hammer_rotation = Quaternion::Identity();
-        RenderModel(_hammer, *_pbr_shader, Vec3::Zero(), hammer_rotation, 1.0f);
+        RenderModel(_hammer, resources, *_pbr_shader, Vec3::Zero(), hammer_rotation, 1.0f);
 
-        RenderModel(_alpine_chalet, *_pbr_shader, Vec3(20, 1, 0), Quaternion::Identity(), 1.0f);
+        RenderModel(_alpine_chalet, resources, *_pbr_shader, Vec3(20, 1, 0), Quaternion::Identity(), 1.0f);
 	}
 
 	void OnEvent(Event& ev) override
@@ -561,8 +553,8 @@ public:
 	void OnInitialize() override
 	{
 		Allocator* layer_alloc = GetLayerAllocator();
-		PushLayer(layer_alloc->New<GameLayer>());
-		PushOverlay(layer_alloc->New<DebugGuiLayer>());
+		PushLayer(HAN_NEW(layer_alloc, GameLayer));
+		PushOverlay(HAN_NEW(layer_alloc, DebugGuiLayer));
 	}
 };
 
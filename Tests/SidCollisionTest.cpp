@@ -0,0 +1,131 @@
+#include "Han/Collections/Array.hpp"
+#include "Han/Collections/String.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Han/Sid.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+
+// Sids are compared by their 64 bit hash only, so two names with the same hash would silently
+// refer to the same resource. This hashes the names the engine interns, and a large set of
+// generated names that look like them, and fails when two different names share a hash.
+
+struct HashedName
+{
+    uint64_t hash;
+    String name;
+};
+
+// Names that are made in code rather than taken from the resources folder.
+static const char* kEngineNames[] = {
+    "u_model",
+    "u_view",
+    "u_projection",
+    "u_view_projection",
+    "u_camera_position",
+    "u_light_position",
+    "u_light_color",
+    "u_flat_color",
+    "u_input_texture",
+    "u_albedo_texture",
+    "u_normal_texture",
+    "u_occlusion_texture",
+    "u_metallic_roughness_texture",
+    "u_metallic_factor",
+    "u_roughness_factor",
+    "wall",
+    "flat_color",
+    "Plane",
+    "Cube",
+};
+
+static void
+AddName(Array<HashedName>* names, const char* name)
+{
+    HashedName hashed = {MakeStringHash(name), String(MallocAllocator::Instance(), name)};
+    names->PushBack(std::move(hashed));
+}
+
+// Resources are interned with their path relative to the resources folder (and shaders with their
+// file name), so every file is added both ways.
+static void
+AddResourceNames(Array<HashedName>* names, const char* resources_path)
+{
+    namespace fs = std::filesystem;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(resources_path, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        const fs::path relative = it->path().lexically_relative(resources_path);
+        AddName(names, relative.generic_string().c_str());
+        AddName(names, relative.filename().generic_string().c_str());
+    }
+}
+
+static void
+AddGeneratedNames(Array<HashedName>* names)
+{
+    char name[64];
+
+    // Every string of one to three printable characters, since short strings take their own path
+    // through the hash.
+    for (int a = ' '; a <= '~'; ++a) {
+        name[0] = (char)a;
+        name[1] = '\0';
+        AddName(names, name);
+        for (int b = ' '; b <= '~'; ++b) {
+            name[1] = (char)b;
+            name[2] = '\0';
+            AddName(names, name);
+            for (int c = ' '; c <= '~'; ++c) {
+                name[2] = (char)c;
+                name[3] = '\0';
+                AddName(names, name);
+            }
+        }
+    }
+
+    // Names that only differ by a counter, like the ones of imported materials and textures.
+    for (int i = 0; i < 200000; ++i) {
+        snprintf(name, sizeof(name), "u_uniform_%d", i);
+        AddName(names, name);
+        snprintf(name, sizeof(name), "material_%d", i);
+        AddName(names, name);
+        snprintf(name, sizeof(name), "textures/texture_%06d.png", i);
+        AddName(names, name);
+        snprintf(name, sizeof(name), "models/level_%d/meshes/mesh_%d.gltf", i % 100, i);
+        AddName(names, name);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <resources folder>\n", argv[0]);
+        return 1;
+    }
+
+    Array<HashedName> names(MallocAllocator::Instance());
+    for (const char* name : kEngineNames) {
+        AddName(&names, name);
+    }
+    AddResourceNames(&names, argv[1]);
+    AddGeneratedNames(&names);
+
+    std::sort(names.begin(), names.end(), [](const HashedName& a, const HashedName& b) {
+        return a.hash < b.hash;
+    });
+
+    int num_collisions = 0;
+    for (size_t i = 1; i < names.len; ++i) {
+        // The same name can be added twice (e.g. a file at the root of the resources folder).
+        if (names[i].hash == names[i - 1].hash && names[i].name != names[i - 1].name) {
+            fprintf(stderr, "Collision: \"%s\" and \"%s\" have the hash %016llx\n",
+                    names[i - 1].name.GetData(),
+                    names[i].name.GetData(),
+                    (unsigned long long)names[i].hash);
+            ++num_collisions;
+        }
+    }
+
+    printf("%zu names hashed, %d collisions\n", names.len, num_collisions);
+    return num_collisions == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Han/Allocator.hpp"
+#include "Han/Collections/Array.hpp"
+#include "Han/Core.hpp"
+#include <mutex>
+#include <stdint.h>
+
+// Records every live allocation of an allocator: its size, call site and the frame it was made in.
+// Trackers are created by the AllocatorFactory when tracking is enabled.
+//
+// The records are kept in an open addressing table keyed by pointer. The table is allocated with
+// malloc directly, so that tracking does not show up in the allocators it tracks.
+class AllocationTracker
+{
+public:
+    struct Record
+    {
+        void* ptr;
+        size_t size;
+        AllocationSite site;
+        uint64_t frame;
+    };
+
+    struct SiteStats
+    {
+        AllocationSite site;
+        size_t bytes;
+        size_t count;
+        uint64_t first_frame;
+    };
+
+    AllocationTracker();
+    ~AllocationTracker();
+
+    DISABLE_OBJECT_COPY_AND_MOVE(AllocationTracker);
+
+    void OnAllocate(void* ptr, size_t size, const AllocationSite& site);
+    void OnDeallocate(void* ptr);
+    // Called when an allocation was resized in place.
+    void OnResize(void* ptr, size_t new_size);
+    // Forgets every allocation in [begin, end), for memory that is released all at once.
+    void OnRelease(void* begin, void* end);
+
+    size_t GetNumLiveAllocations() const;
+    size_t GetLiveBytes() const;
+
+    // Fills out_sites with (at most max_sites) call sites that hold the most live memory,
+    // sorted from the biggest to the smallest.
+    void GetTopSites(Array<SiteStats>* out_sites, size_t max_sites) const;
+
+    // Logs every allocation that is still alive, grouped by call site.
+    void ReportLeaks(const char* allocator_name) const;
+
+private:
+    static constexpr size_t kInitialCapacity = 1024;
+
+    size_t GetSlot(void* ptr) const;
+    void InsertRecord(const Record& record);
+    void RemoveSlot(size_t slot);
+    void Grow();
+
+private:
+    // Empty slots have a null pointer. The capacity is always a power of two.
+    Record* _records;
+    size_t _cap;
+    size_t _len;
+    size_t _live_bytes;
+    mutable std::mutex _mutex;
+};
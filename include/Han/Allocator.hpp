@@ -1,28 +1,142 @@
 #pragma once
 
+#include <atomic>
 #include <new>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <utility>
 
 enum class AllocatorType
 {
 	Malloc,
 	Linear,
+	Stack,
+	VirtualLinear,
+	Tlsf,
 };
 
+// Alignment used when no alignment is specified. It is enough for every fundamental type
+// and for 16 byte SIMD types.
+static constexpr size_t kDefaultAlignment = 16;
+
+// Returns the first address after (or at) addr that is a multiple of alignment.
+// The alignment should be a power of two.
+inline uintptr_t
+AlignForward(uintptr_t addr, size_t alignment)
+{
+    return (addr + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+}
+
+inline bool
+IsPowerOfTwo(size_t n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+// Where an allocation was made from. Used by the allocation tracking.
+// The collections pass their own site, so the memory of a container is reported under its header
+// (Array.hpp, String.hpp, ...) rather than as unknown.
+struct AllocationSite
+{
+    const char* file = nullptr;
+    int line = 0;
+};
+
+#define HAN_ALLOCATION_SITE AllocationSite{__FILE__, __LINE__}
+
+// Like allocator->New<T>(args...), but records the call site when the allocator is tracked.
+#define HAN_NEW(allocator, T, ...) (allocator)->NewAt<T>(HAN_ALLOCATION_SITE, ##__VA_ARGS__)
+
+class AllocationTracker;
+
 struct Allocator
 {
+    virtual ~Allocator() = default;
+
 	virtual AllocatorType GetType() const = 0;
-    virtual void* Allocate(size_t size) = 0;
-    virtual void Deallocate(void* ptr) = 0;
     virtual const char* GetName() const = 0;
 	virtual size_t GetAllocatedBytes() const = 0;
 	virtual size_t GetSize() const = 0;
 
+    void* Allocate(size_t size, size_t alignment = kDefaultAlignment, const AllocationSite& site = AllocationSite())
+    {
+        void* ptr = DoAllocate(size, alignment);
+        _num_allocations.fetch_add(1, std::memory_order_relaxed);
+        AllocationTracker* tracker = _tracker.load(std::memory_order_acquire);
+        if (tracker && ptr) {
+            TrackAllocation(tracker, ptr, size, site);
+        }
+        return ptr;
+    }
+
+    void Deallocate(void* ptr)
+    {
+        if (!ptr) {
+            return;
+        }
+        _num_deallocations.fetch_add(1, std::memory_order_relaxed);
+        if (AllocationTracker* tracker = _tracker.load(std::memory_order_acquire)) {
+            TrackDeallocation(tracker, ptr);
+        }
+        DoDeallocate(ptr);
+    }
+
+    // Tries to grow (or shrink) the allocation at ptr to new_size without moving it. old_size should be
+    // the size it was allocated with. Returns false when the allocator cannot do it, in which case the
+    // allocation is left untouched.
+    bool TryExtend(void* ptr, size_t old_size, size_t new_size)
+    {
+        if (!ptr || !DoTryExtend(ptr, old_size, new_size)) {
+            return false;
+        }
+        if (AllocationTracker* tracker = _tracker.load(std::memory_order_acquire)) {
+            TrackResize(tracker, ptr, new_size);
+        }
+        return true;
+    }
+
+    // Resizes the allocation at ptr, in place when the allocator supports it. Otherwise the first
+    // used_size bytes are copied to a new allocation and the old one is deallocated, so a container
+    // only pays for the elements it holds, not for its whole capacity. ptr can be null.
+    // Returns null when the allocation fails, in which case ptr is still valid.
+    void* Reallocate(void* ptr,
+                     size_t old_size,
+                     size_t used_size,
+                     size_t new_size,
+                     size_t alignment = kDefaultAlignment,
+                     const AllocationSite& site = AllocationSite())
+    {
+        if (TryExtend(ptr, old_size, new_size)) {
+            return ptr;
+        }
+
+        void* new_ptr = Allocate(new_size, alignment, site);
+        if (new_ptr && ptr) {
+            const size_t copy_size = used_size < old_size ? used_size : old_size;
+            if (copy_size > 0) {
+                memcpy(new_ptr, ptr, copy_size < new_size ? copy_size : new_size);
+            }
+            Deallocate(ptr);
+        }
+        return new_ptr;
+    }
+
+    // Returns null, without constructing anything, when the allocation fails (e.g. a full pool).
     template<typename T, typename... Args>
     T* New(Args&&... args)
     {
-        return ::new (Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+        return NewAt<T>(AllocationSite(), std::forward<Args>(args)...);
+    }
+
+    template<typename T, typename... Args>
+    T* NewAt(const AllocationSite& site, Args&&... args)
+    {
+        void* ptr = Allocate(sizeof(T), alignof(T), site);
+        if (!ptr) {
+            return nullptr;
+        }
+        return ::new (ptr) T(std::forward<Args>(args)...);
     }
 
     template<typename T>
@@ -33,5 +147,47 @@ struct Allocator
             Deallocate(ptr);
         }
     }
-};
 
+    // Number of calls to Allocate and Deallocate (with a non null pointer) since the allocator was created.
+    size_t GetNumAllocations() const { return _num_allocations.load(std::memory_order_relaxed); }
+    size_t GetNumDeallocations() const { return _num_deallocations.load(std::memory_order_relaxed); }
+
+    // When a tracker is set, every live allocation is recorded in it. The tracker is not owned.
+    // It can be set while other threads allocate: they see a fully constructed tracker, and only
+    // the allocations made after they see it are recorded.
+    AllocationTracker* GetTracker() const { return _tracker.load(std::memory_order_acquire); }
+    void SetTracker(AllocationTracker* tracker) { _tracker.store(tracker, std::memory_order_release); }
+
+protected:
+    virtual void* DoAllocate(size_t size, size_t alignment) = 0;
+    virtual void DoDeallocate(void* ptr) = 0;
+
+    // Allocators that can resize an allocation in place should override it.
+    virtual bool DoTryExtend(void* ptr, size_t old_size, size_t new_size)
+    {
+        (void)ptr;
+        (void)old_size;
+        (void)new_size;
+        return false;
+    }
+
+    // Should be called by allocators that release memory without Deallocate (Clear, markers, ...).
+    void ReleaseRange(void* begin, void* end)
+    {
+        if (AllocationTracker* tracker = _tracker.load(std::memory_order_acquire)) {
+            TrackRelease(tracker, begin, end);
+        }
+    }
+
+private:
+    // Defined in AllocationTracker.cpp, so that this header does not depend on the tracker.
+    static void TrackAllocation(AllocationTracker* tracker, void* ptr, size_t size, const AllocationSite& site);
+    static void TrackDeallocation(AllocationTracker* tracker, void* ptr);
+    static void TrackResize(AllocationTracker* tracker, void* ptr, size_t new_size);
+    static void TrackRelease(AllocationTracker* tracker, void* begin, void* end);
+
+private:
+    std::atomic<AllocationTracker*> _tracker{nullptr};
+    std::atomic<size_t> _num_allocations{0};
+    std::atomic<size_t> _num_deallocations{0};
+};
@@ -2,10 +2,14 @@
 
 #include "Han/Core.hpp"
 #include "Han/Collections/Array.hpp"
+#include <atomic>
+#include <mutex>
 
 // We declare the class Allocator here. We do not include the header,
 // since there would then be a circular dependency between MemoryProfiler and Allocator.
 struct Allocator;
+class AllocationTracker;
+class StackAllocator;
 
 class AllocatorFactory
 {
@@ -16,6 +20,25 @@ public:
 		Child,
 	};
 
+	// Rolling history of the usage of an allocator, sampled once per frame.
+	struct History
+	{
+		static constexpr int kLength = 240;
+
+		// Ring buffers, the oldest sample is at offset.
+		float bytes_in_use[kLength];
+		float allocations[kLength];
+		float deallocations[kLength];
+		int offset;
+
+		// Highest number of bytes in use seen in a sample.
+		size_t peak_bytes;
+		size_t last_num_allocations;
+		size_t last_num_deallocations;
+
+		void Sample(const Allocator* allocator);
+	};
+
 	struct Node
 	{
 		NodeType type;
@@ -24,11 +47,19 @@ public:
 		// that is, the order of the elements in the nodes array does not change.
 		Array<size_t> children_indices;
 		bool owns;
+		// Memory backing the allocator that is released together with it, if any.
+		void* owned_memory;
+		// Only set when tracking is enabled.
+		AllocationTracker* tracker;
+		History history;
 
 		explicit Node(NodeType type, Allocator* alloc, bool owns)
 			: type(type)
 			, allocator(alloc)
 			, owns(owns)
+			, owned_memory(nullptr)
+			, tracker(nullptr)
+			, history()
 		{}
 
 		void AddChild(size_t index);
@@ -62,13 +93,51 @@ public:
 		return child_allocator;
 	}
 
+	// Records every live allocation (size, call site and frame) of all the allocators,
+	// including the ones that are created afterwards. It is meant for debugging, since every
+	// allocation and deallocation has to update the tracker.
+	// It can be called while other threads allocate. What they allocated before is not recorded.
+	void EnableTracking();
+	bool IsTrackingEnabled() const { return _tracking_enabled; }
+
+	// Logs the allocations that are still alive in every tracked allocator, except the linear ones,
+	// whose memory is never given back one allocation at a time.
+	void ReportLeaks() const;
+
+	// Samples the history of every allocator. The frame number is also stored in the allocation records.
+	void NextFrame();
+	uint64_t GetFrameNumber() const { return _frame_number.load(std::memory_order_relaxed); }
+
+	// Returns a scratch stack that belongs to the calling thread. It is created (and registered)
+	// the first time a thread asks for it, so worker threads can use temporary memory without locking.
+	// When the thread exits, the stack is cleared and kept for the next thread that asks for one, so
+	// there are only as many stacks as threads that used them at the same time.
+	StackAllocator* GetThreadScratchAllocator();
+
+	// The nodes can be reallocated when an allocator is created, so this should not be used
+	// while other threads can create allocators.
 	const Array<Node>& GetNodes() const { return _nodes; }
 
+public:
+	static constexpr size_t kThreadScratchSize = MEGABYTES(4);
+
 private:
 	AllocatorFactory() = default;
-	void AddAllocator(Allocator* parent_allocator, Allocator* child_allocator);
+	void AddAllocator(Allocator* parent_allocator, Allocator* child_allocator, void* owned_memory = nullptr);
+	void TrackNode(Node* node);
+
+	// Gives the scratch stack of a thread back to the factory when the thread exits.
+	struct ThreadScratch;
+	void ReleaseThreadScratchAllocator(StackAllocator* allocator);
 
 private:
 	Allocator* _allocator;
 	Array<Node> _nodes;
+	std::mutex _mutex;
+	int _num_thread_scratch_allocators = 0;
+	// Scratch stacks of the threads that exited, ready to be reused.
+	Array<StackAllocator*> _free_thread_scratch_allocators;
+	bool _tracking_enabled = false;
+	// Read by the trackers from any thread that allocates.
+	std::atomic<uint64_t> _frame_number{0};
 };
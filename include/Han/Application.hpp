@@ -3,6 +3,9 @@
 #include "Han/Allocator.hpp"
 #include "Han/LinearAllocator.hpp"
 #include "Han/MallocAllocator.hpp"
+#include "Han/StackAllocator.hpp"
+#include "Han/TlsfAllocator.hpp"
+#include "Han/VirtualLinearAllocator.hpp"
 #include "Han/Window.hpp"
 #include "Han/Memory.hpp"
 #include "Han/Events.hpp"
@@ -12,10 +15,13 @@
 
 struct ApplicationParams
 {
+	// Address space reserved for the main allocator. Pages are only committed when they are used.
 	size_t memory_size = 0;
 	uint32_t screen_width = 0;
 	uint32_t screen_height = 0;
 	bool vsync = true;
+	// Records the call site of every allocation, and reports the leaks on shutdown.
+	bool track_allocations = false;
 };
 
 class Application
@@ -48,20 +54,29 @@ public:
 	Allocator* GetMainAllocator() { return _main_allocator; }
 	Allocator* GetTempAllocator() { return _temp_allocator; }
 
+	// Memory that lives until the end of the next frame. It is released all at once,
+	// so nothing allocated from it has to be deallocated.
+	Allocator* GetFrameAllocator() { return _frame_allocators[_frame_index]; }
+	// The frame allocator of the previous frame. Its memory is still valid during the current frame.
+	Allocator* GetPreviousFrameAllocator() { return _frame_allocators[_frame_index ^ 1]; }
+
 private:
 	void Initialize();
 	void Shutdown();
 	void OnEvent(Event& ev);
+	void SwapFrameAllocators();
 
 	static Application* _instance;
 
 private:
 	ApplicationParams _params;
-	Memory _memory;
 	Window* _window;
     Allocator* _resource_manager_allocator;
+    StackAllocator* _resource_scratch_allocator;
 	ResourceManager* _resource_manager;
 	bool _running;
+	LinearAllocator* _frame_allocators[2];
+	int _frame_index;
 	std::chrono::high_resolution_clock::time_point _start_time;
 	Time _time;
 
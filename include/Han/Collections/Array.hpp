@@ -4,9 +4,12 @@
 #include <stdint.h>
 #include <assert.h>
 #include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "Han/MallocAllocator.hpp"
 
-#define ARRAY_INITIAL_SIZE 2
+#define ARRAY_INITIAL_SIZE 4
 #define ARRAY_INVALID_POS ((size_t)-1)
 
 template<typename T>
@@ -49,16 +52,20 @@ public:
 
     Array& operator=(const Array& arr)
     {
-        if (data) {
-            allocator->Deallocate(data);
-        }
+        Clear();
         allocator = arr.allocator;
         len = arr.len;
         cap = arr.cap;
-        data = (T*)allocator->Allocate(arr.cap * sizeof(T));
+        data = (T*)allocator->Allocate(arr.cap * sizeof(T), alignof(T), HAN_ALLOCATION_SITE);
 
         assert(data && "copy should not fail");
-        memcpy(data, arr.data, sizeof(T) * arr.len);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            memcpy(data, arr.data, sizeof(T) * arr.len);
+        } else {
+            for (size_t i = 0; i < arr.len; ++i) {
+                new (data + i) T(arr.data[i]);
+            }
+        }
         return *this;
     }
 
@@ -77,9 +84,7 @@ public:
 
     Array& operator=(Array&& arr)
     {
-        if (data) {
-            allocator->Deallocate(data);
-        }
+        Clear();
         allocator = arr.allocator;
         data = arr.data;
         len = arr.len;
@@ -101,42 +106,77 @@ public:
 			}
             allocator->Deallocate(data);
         }
+        data = nullptr;
+        len = 0;
+        cap = 0;
 	}
 
-    void PushBack(T el)
+    void PushBack(const T& el) { EmplaceBack(el); }
+
+    void PushBack(T&& el) { EmplaceBack(std::move(el)); }
+
+    // Constructs a new element at the end of the array from args.
+    template<typename... Args>
+    T& EmplaceBack(Args&&... args)
     {
-        if (!data) {
-            cap = ARRAY_INITIAL_SIZE;
-            data = (T*)allocator->Allocate(sizeof(T) * ARRAY_INITIAL_SIZE);
-            len = 0;
-            assert(data);
+        if (len == cap) {
+            // args could point into the array, so the element is built before the array moves.
+            T el(std::forward<Args>(args)...);
+            Grow(len + 1);
+            return *new (data + len++) T(std::move(el));
         }
+        return *new (data + len++) T(std::forward<Args>(args)...);
+    }
 
-        if (len == cap) {
-            // Resize array
-            size_t new_cap = (size_t)(cap * 1.5f);
-			Resize(new_cap);
+    // Destroys the last element.
+    void PopBack()
+    {
+        assert(len > 0);
+        data[--len].~T();
+    }
+
+    // Copies num_elements elements at the end of the array, growing it at most once.
+    // elements should not point into the array.
+    void Append(const T* elements, size_t num_elements)
+    {
+        if (len + num_elements > cap) {
+            Grow(len + num_elements);
         }
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (num_elements > 0) {
+                memcpy(data + len, elements, sizeof(T) * num_elements);
+            }
+        } else {
+            for (size_t i = 0; i < num_elements; ++i) {
+                new (data + len + i) T(elements[i]);
+            }
+        }
+        len += num_elements;
+    }
 
-        new (data + len) T(std::move(el)); // create default instance of T
-        ++len;
+    // Makes room for at least capacity elements, so that adding up to capacity elements does not allocate.
+    void Reserve(size_t capacity)
+    {
+        if (capacity > cap) {
+            Resize(capacity);
+        }
+    }
+
+    // Sets the length to new_len without constructing the new elements, which should be written
+    // before they are read. Only for types that do not need construction or destruction.
+    void ResizeUninitialized(size_t new_len)
+    {
+        static_assert(std::is_trivial<T>::value, "Elements should be trivial to be left uninitialized");
+        Reserve(new_len);
+        len = new_len;
     }
 
 	ConstIterator Insert(ConstIterator it, T el)
 	{
 		ASSERT(it >= data, "Iterator should be the same or come after data");
 
-		if (!data) {
-            cap = ARRAY_INITIAL_SIZE;
-            data = (T*)allocator->Allocate(sizeof(T) * ARRAY_INITIAL_SIZE);
-            len = 0;
-			ASSERT(data, "Allocation should not fail");
-		}
-
         if (len == cap) {
-            // Resize array
-            size_t new_cap = (size_t)(cap * 1.5f);
-			Resize(new_cap);
+			Grow(len + 1);
         }
 
 		if (it == nullptr) {
@@ -240,14 +280,34 @@ public:
     ConstIterator cend() const { return data + len; }
 
 private:
+	// Doubles the capacity, or grows it to min_cap if that is not enough.
+	void Grow(size_t min_cap)
+	{
+		size_t new_cap = cap > 0 ? cap * 2 : ARRAY_INITIAL_SIZE;
+		Resize(new_cap > min_cap ? new_cap : min_cap);
+	}
+
+	// Grows the array in place when the allocator allows it (e.g. the last allocation of a linear
+	// allocator), otherwise the elements are copied to a new block. Elements that are not trivially
+	// copyable (e.g. a String pointing into itself) are moved one by one.
 	void Resize(size_t new_cap)
 	{
-		size_t size = new_cap * sizeof(T);
-		T* new_data = (T*)allocator->Allocate(size);
-		assert(new_data);
-		memcpy(new_data, data, len * sizeof(T));
-		allocator->Deallocate(data);
-		data = new_data;
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			T* new_data = (T*)allocator->Reallocate(data, cap * sizeof(T), len * sizeof(T), new_cap * sizeof(T), alignof(T), HAN_ALLOCATION_SITE);
+			assert(new_data);
+			data = new_data;
+		} else if (!data || !allocator->TryExtend(data, cap * sizeof(T), new_cap * sizeof(T))) {
+			T* new_data = (T*)allocator->Allocate(new_cap * sizeof(T), alignof(T), HAN_ALLOCATION_SITE);
+			assert(new_data);
+			for (size_t i = 0; i < len; ++i) {
+				new (new_data + i) T(std::move(data[i]));
+				data[i].~T();
+			}
+			if (data) {
+				allocator->Deallocate(data);
+			}
+			data = new_data;
+		}
 		cap = new_cap;
 	}
 
@@ -0,0 +1,409 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Han/Core.hpp"
+#include "Han/Hash.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Han/Collections/StringView.hpp"
+
+#if ARCH_X86 && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define HAN_FLAT_HASH_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if COMPILER_MSC
+#include <intrin.h>
+#endif
+
+// Open addressing hash map in the style of the Swiss tables: every slot has a control byte that
+// tells if it is empty, deleted, or holds an element together with 7 bits of its hash.
+// The control bytes are kept apart from the elements and probed kGroupSize at a time (with SSE2
+// when available), so most lookups compare a single group of control bytes and one key.
+//
+// The capacity is always a power of two and a multiple of kGroupSize. Groups are probed with
+// triangular steps, which visit every group of a power of two table.
+//
+// Removed elements leave a deleted control byte behind. They are cleaned up when the table is
+// rehashed, either to grow it or to get rid of the tombstones when there are too many of them.
+template<typename Key, typename Value>
+class FlatHashMap
+{
+public:
+    static constexpr size_t kGroupSize = 16;
+    static constexpr size_t kMinCapacity = kGroupSize;
+
+    struct Element
+    {
+        Key key;
+        Value val;
+    };
+
+    class iterator
+    {
+    public:
+        iterator(const FlatHashMap* map, size_t index)
+            : _map(map)
+            , _index(index)
+        {
+            SkipFreeSlots();
+        }
+
+        iterator& operator++()
+        {
+            ++_index;
+            SkipFreeSlots();
+            return *this;
+        }
+        iterator operator++(int) { iterator ret = *this; ++(*this); return ret; }
+
+        bool operator==(const iterator& other) const { return _index == other._index; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+        Element& operator*() const { return _map->_elements[_index]; }
+        Element* operator->() const { return &_map->_elements[_index]; }
+
+    private:
+        void SkipFreeSlots()
+        {
+            while (_index < _map->_cap && !IsFull(_map->_ctrl[_index])) {
+                ++_index;
+            }
+        }
+
+        const FlatHashMap* _map;
+        size_t _index;
+    };
+
+    using const_iterator = iterator;
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, _cap); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+public:
+    FlatHashMap(Allocator* allocator, size_t cap)
+        : _allocator(allocator)
+        , _ctrl(nullptr)
+        , _elements(nullptr)
+        , _cap(0)
+        , _len(0)
+        , _growth_left(0)
+    {
+        if (allocator && cap > 0) {
+            Reserve(cap);
+        }
+    }
+
+    explicit FlatHashMap(Allocator* allocator)
+        : FlatHashMap(allocator, 0)
+    {}
+
+    FlatHashMap()
+        : FlatHashMap(MallocAllocator::Instance(), 0)
+    {}
+
+    FlatHashMap(FlatHashMap&& other)
+        : FlatHashMap(nullptr, 0)
+    {
+        *this = std::move(other);
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other)
+    {
+        Destroy();
+        _allocator = other._allocator;
+        _ctrl = other._ctrl;
+        _elements = other._elements;
+        _cap = other._cap;
+        _len = other._len;
+        _growth_left = other._growth_left;
+        other._ctrl = nullptr;
+        other._elements = nullptr;
+        other._cap = 0;
+        other._len = 0;
+        other._growth_left = 0;
+        return *this;
+    }
+
+    ~FlatHashMap() { Destroy(); }
+
+    DISABLE_OBJECT_COPY(FlatHashMap);
+
+    size_t GetLen() const { return _len; }
+    size_t GetCap() const { return _cap; }
+    Allocator* GetAllocator() const { return _allocator; }
+
+    // Adds the element, or replaces the value when the key is already in the map.
+    void Add(Key key, Value value)
+    {
+        const uint64_t hash = HashKey(key);
+        size_t index;
+        if (FindIndex(key, hash, &index)) {
+            _elements[index].val = std::move(value);
+            return;
+        }
+
+        if (_growth_left == 0) {
+            // Rehashing at the same capacity is enough when most of the used slots are tombstones.
+            if (_cap == 0) {
+                Rehash(kMinCapacity);
+            } else {
+                Rehash(_len * 2 < GetMaxLen(_cap) ? _cap : _cap * 2);
+            }
+        }
+
+        index = FindInsertIndex(hash);
+        if (_ctrl[index] == kEmpty) {
+            --_growth_left;
+        }
+        SetCtrl(index, GetH2(hash));
+        new (_elements + index) Element{std::move(key), std::move(value)};
+        ++_len;
+    }
+
+    const Value* Find(const Key& key) const { return FindHelper(key); }
+    Value* Find(const Key& key) { return FindHelper(key); }
+
+    // Finds with a key of another type (see IsTransparentKey), e.g. a StringView in a String keyed map.
+    template<typename LookupKey, typename = std::enable_if_t<IsTransparentKey<Key, LookupKey>::value>>
+    const Value* Find(const LookupKey& key) const { return FindHelper(key); }
+
+    template<typename LookupKey, typename = std::enable_if_t<IsTransparentKey<Key, LookupKey>::value>>
+    Value* Find(const LookupKey& key) { return FindHelper(key); }
+
+    template<typename K = Key, typename = std::enable_if_t<IsTransparentKey<K, StringView>::value>>
+    const Value* Find(const char* key) const { return FindHelper(StringView(key)); }
+
+    template<typename K = Key, typename = std::enable_if_t<IsTransparentKey<K, StringView>::value>>
+    Value* Find(const char* key) { return FindHelper(StringView(key)); }
+
+    // Returns false when the key is not in the map.
+    bool Remove(const Key& key)
+    {
+        size_t index;
+        if (!FindIndex(key, HashKey(key), &index)) {
+            return false;
+        }
+
+        _elements[index].~Element();
+        SetCtrl(index, kDeleted);
+        --_len;
+        return true;
+    }
+
+    // Removes every element, but keeps the memory of the table.
+    void Clear()
+    {
+        DestroyElements();
+        if (_ctrl) {
+            memset(_ctrl, kEmpty, _cap);
+        }
+        _len = 0;
+        _growth_left = GetMaxLen(_cap);
+    }
+
+    // Makes room for num elements without growing again.
+    void Reserve(size_t num)
+    {
+        size_t new_cap = kMinCapacity;
+        while (GetMaxLen(new_cap) < num) {
+            new_cap *= 2;
+        }
+        if (new_cap > _cap) {
+            Rehash(new_cap);
+        }
+    }
+
+private:
+    // Control bytes. Full slots store the 7 lowest bits of the hash, so their top bit is clear.
+    static constexpr int8_t kEmpty = (int8_t)0x80;
+    static constexpr int8_t kDeleted = (int8_t)0xFE;
+
+    static bool IsFull(int8_t ctrl) { return ctrl >= 0; }
+
+    // The table is rehashed when 7/8 of the slots are in use (elements and tombstones).
+    static size_t GetMaxLen(size_t cap) { return cap - cap / 8; }
+
+    template<typename HashedKey>
+    static uint64_t HashKey(const HashedKey& key)
+    {
+        std::hash<HashedKey> hasher;
+        // Mix the bits, since the groups are picked from the high bits and the control bytes take
+        // the low ones.
+        const uint64_t h = (uint64_t)hasher(key) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+
+    static int8_t GetH2(uint64_t hash) { return (int8_t)(hash & 0x7F); }
+    static size_t GetH1(uint64_t hash) { return (size_t)(hash >> 7); }
+
+    // Bitmask of the slots in the group (starting at index) whose control byte is ctrl.
+    uint32_t MatchByte(size_t index, int8_t ctrl) const
+    {
+#if HAN_FLAT_HASH_MAP_SSE2
+        const __m128i group = _mm_load_si128((const __m128i*)(_ctrl + index));
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(ctrl)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            mask |= (uint32_t)(_ctrl[index + i] == ctrl) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Bitmask of the slots in the group (starting at index) that are empty or deleted.
+    uint32_t MatchFree(size_t index) const
+    {
+#if HAN_FLAT_HASH_MAP_SSE2
+        const __m128i group = _mm_load_si128((const __m128i*)(_ctrl + index));
+        return (uint32_t)_mm_movemask_epi8(group);
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            mask |= (uint32_t)(!IsFull(_ctrl[index + i])) << i;
+        }
+        return mask;
+#endif
+    }
+
+    static int LowestBit(uint32_t mask)
+    {
+#if COMPILER_MSC
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    template<typename LookupKey>
+    Value* FindHelper(const LookupKey& key) const
+    {
+        size_t index;
+        if (FindIndex(key, HashKey(key), &index)) {
+            return &_elements[index].val;
+        }
+        return nullptr;
+    }
+
+    template<typename LookupKey>
+    bool FindIndex(const LookupKey& key, uint64_t hash, size_t* out_index) const
+    {
+        if (_len == 0) {
+            return false;
+        }
+
+        const size_t group_mask = _cap / kGroupSize - 1;
+        const int8_t h2 = GetH2(hash);
+        size_t group = GetH1(hash) & group_mask;
+        for (size_t step = 1; step <= group_mask + 1; ++step) {
+            const size_t group_index = group * kGroupSize;
+            for (uint32_t mask = MatchByte(group_index, h2); mask != 0; mask &= mask - 1) {
+                const size_t index = group_index + LowestBit(mask);
+                if (_elements[index].key == key) {
+                    *out_index = index;
+                    return true;
+                }
+            }
+
+            // An empty slot ends the probe sequence: the key would have been inserted there.
+            if (MatchByte(group_index, kEmpty) != 0) {
+                return false;
+            }
+            group = (group + step) & group_mask;
+        }
+        return false;
+    }
+
+    // The first empty or deleted slot of the probe sequence of the hash.
+    size_t FindInsertIndex(uint64_t hash) const
+    {
+        const size_t group_mask = _cap / kGroupSize - 1;
+        size_t group = GetH1(hash) & group_mask;
+        for (size_t step = 1;; ++step) {
+            const size_t group_index = group * kGroupSize;
+            const uint32_t mask = MatchFree(group_index);
+            if (mask != 0) {
+                return group_index + LowestBit(mask);
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    void SetCtrl(size_t index, int8_t ctrl) { _ctrl[index] = ctrl; }
+
+    void Rehash(size_t new_cap)
+    {
+        assert(_allocator);
+        assert(IsPowerOfTwo(new_cap) && new_cap >= kGroupSize);
+
+        int8_t* old_ctrl = _ctrl;
+        Element* old_elements = _elements;
+        const size_t old_cap = _cap;
+
+        // The control bytes and the elements share a single allocation.
+        const size_t elements_offset = AlignForward(new_cap, alignof(Element));
+        const size_t alignment = HAN_MAX(kGroupSize, alignof(Element));
+        uint8_t* mem = (uint8_t*)_allocator->Allocate(elements_offset + new_cap * sizeof(Element), alignment, HAN_ALLOCATION_SITE);
+        assert(mem);
+
+        _ctrl = (int8_t*)mem;
+        _elements = (Element*)(mem + elements_offset);
+        _cap = new_cap;
+        _growth_left = GetMaxLen(new_cap) - _len;
+        memset(_ctrl, kEmpty, new_cap);
+
+        for (size_t i = 0; i < old_cap; ++i) {
+            if (IsFull(old_ctrl[i])) {
+                Element& element = old_elements[i];
+                const uint64_t hash = HashKey(element.key);
+                const size_t index = FindInsertIndex(hash);
+                SetCtrl(index, GetH2(hash));
+                new (_elements + index) Element{std::move(element.key), std::move(element.val)};
+                element.~Element();
+            }
+        }
+
+        if (old_ctrl) {
+            _allocator->Deallocate(old_ctrl);
+        }
+    }
+
+    void DestroyElements()
+    {
+        for (size_t i = 0; i < _cap; ++i) {
+            if (IsFull(_ctrl[i])) {
+                _elements[i].~Element();
+            }
+        }
+    }
+
+    void Destroy()
+    {
+        if (_ctrl) {
+            DestroyElements();
+            _allocator->Deallocate(_ctrl);
+        }
+        _ctrl = nullptr;
+        _elements = nullptr;
+        _cap = 0;
+        _len = 0;
+        _growth_left = 0;
+    }
+
+private:
+    Allocator* _allocator;
+    int8_t* _ctrl;
+    Element* _elements;
+    size_t _cap;
+    size_t _len;
+    // Number of empty slots that can still be used before the table has to be rehashed.
+    size_t _growth_left;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Han/Allocator.hpp"
+#include "Han/Core.hpp"
+#include "Han/Collections/Array.hpp"
+#include <stdint.h>
+#include <utility>
+
+// 32 bit reference to an element of a HandlePool. The low bits are the index of a slot, the high bits
+// the generation of that slot when the element was added. The value 0 is never given out, so a zero
+// initialized handle is invalid.
+template<typename T>
+struct Handle
+{
+    uint32_t value;
+
+    bool IsValid() const { return value != 0; }
+
+    bool operator==(const Handle& other) const { return value == other.value; }
+    bool operator!=(const Handle& other) const { return value != other.value; }
+};
+
+// Slot map: the elements are stored densely in one array and are referenced through handles.
+// Adding and removing are O(1). Removing moves the last element into the hole, so elements do not
+// keep their address, but their handles stay valid. Once an element is removed, its slot gets a new
+// generation and every handle to it stops resolving, instead of pointing to whatever reuses the slot.
+// Generations have 12 bits, so a stale handle could only resolve again after 4095 reuses of its slot.
+template<typename T>
+class HandlePool
+{
+public:
+    static constexpr uint32_t kIndexBits = 20;
+    static constexpr uint32_t kMaxSlots = 1u << kIndexBits;
+    static constexpr uint32_t kIndexMask = kMaxSlots - 1;
+    static constexpr uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+
+    HandlePool()
+        : HandlePool(MallocAllocator::Instance())
+    {}
+
+    explicit HandlePool(Allocator* allocator, size_t capacity = 0)
+        : _elements(allocator)
+        , _element_slots(allocator)
+        , _slots(allocator)
+        , _free_head(kNoSlot)
+    {
+        Reserve(capacity);
+    }
+
+    HandlePool(HandlePool&& other) = default;
+    HandlePool& operator=(HandlePool&& other) = default;
+
+    DISABLE_OBJECT_COPY(HandlePool);
+
+    void Reserve(size_t capacity)
+    {
+        _elements.Reserve(capacity);
+        _element_slots.Reserve(capacity);
+        _slots.Reserve(capacity);
+    }
+
+    // Constructs a new element from args and returns its handle.
+    template<typename... Args>
+    Handle<T> Add(Args&&... args)
+    {
+        uint32_t slot_index;
+        if (_free_head != kNoSlot) {
+            slot_index = _free_head;
+            _free_head = _slots[slot_index].index;
+        } else {
+            ASSERT(_slots.len < kMaxSlots, "Handle pool is full");
+            slot_index = (uint32_t)_slots.len;
+            _slots.PushBack(Slot{0, 1});
+        }
+
+        Slot& slot = _slots[slot_index];
+        slot.index = (uint32_t)_elements.len;
+        _elements.EmplaceBack(std::forward<Args>(args)...);
+        _element_slots.PushBack(slot_index);
+        return MakeHandle(slot_index, slot.generation);
+    }
+
+    // Destroys the element of the handle. Returns false when the handle does not resolve.
+    bool Remove(Handle<T> handle)
+    {
+        const uint32_t slot_index = handle.value & kIndexMask;
+        if (!IsAlive(handle)) {
+            return false;
+        }
+
+        // Fill the hole with the last element.
+        const uint32_t index = _slots[slot_index].index;
+        const uint32_t last_index = (uint32_t)_elements.len - 1;
+        if (index != last_index) {
+            _elements[index] = std::move(_elements[last_index]);
+            _element_slots[index] = _element_slots[last_index];
+            _slots[_element_slots[index]].index = index;
+        }
+        _elements.PopBack();
+        _element_slots.PopBack();
+
+        Slot& slot = _slots[slot_index];
+        slot.generation = (slot.generation + 1) & kGenerationMask;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        slot.index = _free_head;
+        _free_head = slot_index;
+        return true;
+    }
+
+    // Returns the element of the handle, or null when it was removed. The pointer is valid until the
+    // next Add or Remove.
+    T* Get(Handle<T> handle)
+    {
+        return IsAlive(handle) ? &_elements[_slots[handle.value & kIndexMask].index] : nullptr;
+    }
+
+    const T* Get(Handle<T> handle) const
+    {
+        return IsAlive(handle) ? &_elements[_slots[handle.value & kIndexMask].index] : nullptr;
+    }
+
+    bool IsAlive(Handle<T> handle) const
+    {
+        const uint32_t slot_index = handle.value & kIndexMask;
+        return handle.IsValid() && slot_index < _slots.len &&
+               _slots[slot_index].generation == handle.value >> kIndexBits;
+    }
+
+    // Returns the handle of the element at index in the dense storage, i.e. of *(begin() + index).
+    Handle<T> GetHandle(size_t index) const
+    {
+        const uint32_t slot_index = _element_slots[index];
+        return MakeHandle(slot_index, _slots[slot_index].generation);
+    }
+
+    // Removes every element. Handles given out before do not resolve anymore.
+    void Clear()
+    {
+        while (_elements.len > 0) {
+            Remove(GetHandle(_elements.len - 1));
+        }
+    }
+
+    size_t GetLen() const { return _elements.len; }
+
+    // Iteration goes over the packed elements, in no particular order.
+    T* begin() const { return _elements.begin(); }
+    T* end() const { return _elements.end(); }
+
+private:
+    static constexpr uint32_t kNoSlot = 0xffffffffu;
+
+    struct Slot
+    {
+        // Index of the element in the dense storage, or the next free slot when the slot is free.
+        uint32_t index;
+        // Generation of the handles that resolve to this slot. Never 0.
+        uint32_t generation;
+    };
+
+    static Handle<T> MakeHandle(uint32_t slot_index, uint32_t generation)
+    {
+        return Handle<T>{(generation << kIndexBits) | slot_index};
+    }
+
+private:
+    Array<T> _elements;
+    // Slot of every element, in the same order as the elements.
+    Array<uint32_t> _element_slots;
+    Array<Slot> _slots;
+    uint32_t _free_head;
+};
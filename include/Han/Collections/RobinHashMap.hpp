@@ -3,15 +3,30 @@
 #include <assert.h>
 #include <stdint.h>
 #include <algorithm>
+#include <type_traits>
+#include "Han/Hash.hpp"
 #include "Han/MallocAllocator.hpp"
-
-// Currently this hash map does not support rehashing
+#include "Han/Collections/StringView.hpp"
+
+// Open addressing hash map with Robin Hood probing. The table doubles its capacity (and rehashes
+// every element) when the load factor goes above kMaxLoadFactor, so the initial capacity is only
+// a hint of the expected number of elements.
+//
+// The capacity is always a power of two, so positions are computed with a shift and probing wraps
+// around with a mask. The hashes are mixed with fibonacci hashing before taking the top bits,
+// since hashes such as Sids are not evenly spread in their low bits.
+//
+// Removing uses backward shift deletion: the elements that follow the removed one are moved one
+// slot back until an empty slot (or an element in its desired position) is found. No tombstones
+// are left behind, so an empty slot (hash 0) always ends a probe sequence.
 template<typename Key, typename Value>
 class RobinHashMap
 {
 public:
     // The maximum load allowed on the table before we need to rehash it.
     static constexpr float kMaxLoadFactor = 0.9f;
+    // Capacity used for the first allocation of a map created without capacity.
+    static constexpr size_t kMinCapacity = 16;
 
 	struct Element
 	{
@@ -52,10 +67,7 @@ public:
                     break;
                 }
 
-                if (_element->_hash == 0 ||
-                    (_element->_hash >> 31) != 0) {
-                    continue;
-                } else {
+                if (_element->_hash != 0) {
                     break;
                 }
             }
@@ -86,9 +98,7 @@ public:
     iterator begin() const
     {
         for (size_t i = 0; i < cap; ++i) {
-            if (IsDeleted(elements[i]._hash) || elements[i]._hash == 0) {
-                continue;
-            } else {
+            if (elements[i]._hash != 0) {
                 return iterator(&elements[i], elements + cap);
             }
         }
@@ -100,9 +110,7 @@ public:
     const_iterator cbegin() const 
     {
         for (size_t i = 0; i < cap; ++i) {
-            if (IsDeleted(elements[i]._hash) || elements[i]._hash == 0) {
-                continue;
-            } else {
+            if (elements[i]._hash != 0) {
                 return iterator(&elements[i], elements + cap);
             }
         }
@@ -113,24 +121,29 @@ public:
 public:
 	Allocator* allocator;
     Element* elements;
+    // Always a power of two (or 0 before the first allocation).
     size_t cap;
 	size_t num_elements;
     size_t max_num_elements_allowed;
+    // 32 - log2(cap), used to take the top bits of the mixed hash.
+    uint32_t hash_shift;
 
 public:
 	RobinHashMap(Allocator* allocator, size_t cap)
 		: allocator(allocator)
 		, elements(nullptr)
-        , cap(cap)
+        , cap(0)
 		, num_elements(0)
-        , max_num_elements_allowed((size_t)(kMaxLoadFactor * cap))
+        , max_num_elements_allowed(0)
+        , hash_shift(32)
 	{
-        if (allocator) {
-            elements = (Element*)allocator->Allocate(sizeof(Element) * cap);
-            assert(elements);
-            for (size_t i = 0; i < cap; ++i) {
-                elements[i]._hash = 0; // All elements are free
+        if (allocator && cap > 0) {
+            // Round up to a power of two.
+            size_t new_cap = kMinCapacity;
+            while (new_cap < cap) {
+                new_cap *= 2;
             }
+            Rehash(new_cap);
         }
     }
 
@@ -143,48 +156,155 @@ public:
 	{}
 
     RobinHashMap(RobinHashMap&& other)
+        : allocator(nullptr)
+        , elements(nullptr)
+        , cap(0)
+        , num_elements(0)
+        , max_num_elements_allowed(0)
+        , hash_shift(32)
     {
         *this = std::move(other);
     }
 
     RobinHashMap& operator=(RobinHashMap&& other)
     {
+        Destroy();
         allocator = other.allocator;
         elements = other.elements;
         cap = other.cap;
         num_elements = other.num_elements;
         max_num_elements_allowed = other.max_num_elements_allowed;
+        hash_shift = other.hash_shift;
         other.allocator = nullptr;
         other.elements = nullptr;
         other.cap = 0;
         other.num_elements = 0;
         other.max_num_elements_allowed = 0;
+        other.hash_shift = 32;
         return *this;
     }
 
-    ~RobinHashMap()
+    ~RobinHashMap() { Destroy(); }
+
+    // Adds the element, or replaces the value when the key is already in the map.
+    void Add(Key key, Value value)
     {
-        if (elements) {
-            for (size_t i = 0; i < cap; ++i) {
-                if (elements[i]._hash != 0 && !IsDeleted(elements[i]._hash)) {
-                    elements[i].key.~Key();
-                    elements[i].val.~Value();
-                }
+        const uint32_t hash = HashKey(key);
+        size_t pos;
+        if (FindPosition(key, hash, &pos)) {
+            elements[pos].val = std::move(value);
+            return;
+        }
+
+        if (num_elements >= max_num_elements_allowed) {
+            Grow();
+        }
+        Insert(hash, std::move(key), std::move(value));
+    }
+
+    // Makes room for num elements without growing again.
+    void Reserve(size_t num)
+    {
+        const size_t new_cap = GetCapacityFor(num);
+        if (new_cap > cap) {
+            Rehash(new_cap);
+        }
+    }
+
+    const Value* Find(const Key& key) const
+    {
+        Value* val;
+        if (FindHelper(key, &val)) {
+            return const_cast<const Value*>(val);
+        } else {
+            return nullptr;
+        }
+    }
+
+    Value* Find(const Key& key)
+    {
+        Value* val;
+        if (FindHelper(key, &val)) {
+            return val;
+        } else {
+            return nullptr;
+        }
+    }
+
+    // Finds with a key of another type (see IsTransparentKey), e.g. a StringView in a String keyed map.
+    template<typename LookupKey, typename = std::enable_if_t<IsTransparentKey<Key, LookupKey>::value>>
+    const Value* Find(const LookupKey& key) const
+    {
+        Value* val;
+        return FindHelper(key, &val) ? val : nullptr;
+    }
+
+    template<typename LookupKey, typename = std::enable_if_t<IsTransparentKey<Key, LookupKey>::value>>
+    Value* Find(const LookupKey& key)
+    {
+        Value* val;
+        return FindHelper(key, &val) ? val : nullptr;
+    }
+
+    // Maps with string keys can be probed with a C string.
+    template<typename K = Key, typename = std::enable_if_t<IsTransparentKey<K, StringView>::value>>
+    const Value* Find(const char* key) const
+    {
+        return Find(StringView(key));
+    }
+
+    template<typename K = Key, typename = std::enable_if_t<IsTransparentKey<K, StringView>::value>>
+    Value* Find(const char* key)
+    {
+        return Find(StringView(key));
+    }
+
+    // Returns false when the key is not in the map.
+    bool Remove(const Key& key)
+    {
+        size_t pos;
+        if (!FindPosition(key, &pos)) {
+            return false;
+        }
+
+        elements[pos].key.~Key();
+        elements[pos].val.~Value();
+        elements[pos]._hash = 0;
+        --num_elements;
+
+        // Move back the elements that are not in their desired position, to fill the hole.
+        const size_t mask = GetMask();
+        size_t next = (pos + 1) & mask;
+        while (elements[next]._hash != 0 && GetProbeDistance(elements[next]._hash, next) > 0) {
+            new (elements + pos) Element(elements[next]._hash, std::move(elements[next].key), std::move(elements[next].val));
+            elements[next].key.~Key();
+            elements[next].val.~Value();
+            elements[next]._hash = 0;
+            pos = next;
+            next = (next + 1) & mask;
+        }
+        return true;
+    }
+
+    // Removes every element, but keeps the memory of the table.
+    void Clear()
+    {
+        for (size_t i = 0; i < cap; ++i) {
+            if (elements[i]._hash != 0) {
+                elements[i].key.~Key();
+                elements[i].val.~Value();
+                elements[i]._hash = 0;
             }
-            allocator->Deallocate(elements);
         }
+        num_elements = 0;
     }
 
-    void Add(Key key, Value value)
+private:
+    void Insert(uint32_t hash, Key&& key, Value&& value)
     {
-        // TODO: eventually implement rehashing
-        assert(num_elements < max_num_elements_allowed);
-        uint32_t hash = HashKey(key);
         size_t pos = GetDesiredPosition(hash);
         size_t probe_distance = 0;
-        size_t mask = GetMask();
-
-        assert(pos < cap);
+        const size_t mask = GetMask();
 
         for (;;) {
             if (elements[pos]._hash == 0) {
@@ -197,63 +317,133 @@ public:
             // was probed less than us, and if it is so, we change positions.
             size_t current_position_probe_dist = GetProbeDistance(elements[pos]._hash, pos);
             if (current_position_probe_dist < probe_distance) {
-                if (IsDeleted(elements[pos]._hash)) {
-                    EmplaceElement(pos, hash, std::move(key), std::move(value));
-                    return;
-                }
-
                 probe_distance = current_position_probe_dist;
                 std::swap(key, elements[pos].key);
                 std::swap(value, elements[pos].val);
                 std::swap(hash, elements[pos]._hash);
             }
 
-            pos = (pos + 1) % mask;
+            pos = (pos + 1) & mask;
             ++probe_distance;
         }
     }
 
-    const Value* Find(const Key& key) const
+    // The smallest power of two capacity that holds num elements under the max load factor.
+    static size_t GetCapacityFor(size_t num)
     {
-        Value* val;
-        if (FindHelper(key, &val)) {
-            return const_cast<const Value*>(val);
-        } else {
-            return nullptr;
+        size_t new_cap = kMinCapacity;
+        while ((size_t)(kMaxLoadFactor * new_cap) < num) {
+            new_cap *= 2;
         }
+        return new_cap;
     }
 
-    Value* Find(const Key& key)
+    // Doubles the capacity. The cost of moving the elements is amortized over the insertions.
+    void Grow()
     {
-        Value* val;
-        if (FindHelper(key, &val)) {
-            return val;
+        Rehash(cap > 0 ? cap * 2 : kMinCapacity);
+    }
+
+    void Rehash(size_t new_cap)
+    {
+        assert(allocator);
+        assert(IsPowerOfTwo(new_cap) && new_cap <= ((size_t)1 << 31));
+        Element* old_elements = elements;
+        const size_t old_cap = cap;
+
+        elements = AllocateElements(new_cap);
+        cap = new_cap;
+        num_elements = 0;
+        max_num_elements_allowed = (size_t)(kMaxLoadFactor * new_cap);
+        hash_shift = 32;
+        for (size_t n = new_cap; n > 1; n >>= 1) {
+            --hash_shift;
+        }
+
+        for (size_t i = 0; i < old_cap; ++i) {
+            Element& element = old_elements[i];
+            if (element._hash != 0) {
+                Insert(element._hash, std::move(element.key), std::move(element.val));
+                element.key.~Key();
+                element.val.~Value();
+            }
+        }
+
+        if (old_elements) {
+            allocator->Deallocate(old_elements);
+        }
+    }
+
+    Element* AllocateElements(size_t num)
+    {
+        Element* new_elements = (Element*)allocator->Allocate(sizeof(Element) * num, alignof(Element), HAN_ALLOCATION_SITE);
+        assert(new_elements);
+        for (size_t i = 0; i < num; ++i) {
+            new_elements[i]._hash = 0; // All elements are free
+        }
+        return new_elements;
+    }
+
+    void Destroy()
+    {
+        if (elements) {
+            for (size_t i = 0; i < cap; ++i) {
+                if (elements[i]._hash != 0) {
+                    elements[i].key.~Key();
+                    elements[i].val.~Value();
+                }
+            }
+            allocator->Deallocate(elements);
+        }
+        elements = nullptr;
+        cap = 0;
+        num_elements = 0;
+        max_num_elements_allowed = 0;
+        hash_shift = 32;
+    }
+
+    template<typename LookupKey>
+    bool FindHelper(const LookupKey& key, Value** out_val) const
+    {
+        size_t pos;
+        if (FindPosition(key, &pos)) {
+            *out_val = &elements[pos].val;
+            return true;
         } else {
-            return nullptr;
+            *out_val = nullptr;
+            return false;
         }
     }
 
-private:
-    bool FindHelper(const Key& key, Value** out_val) const
+    template<typename LookupKey>
+    bool FindPosition(const LookupKey& key, size_t* out_pos) const
+    {
+        return FindPosition(key, HashKey(key), out_pos);
+    }
+
+    template<typename LookupKey>
+    bool FindPosition(const LookupKey& key, uint32_t hash, size_t* out_pos) const
     {
+        if (num_elements == 0) {
+            return false;
+        }
+
         const size_t mask = GetMask();
-        const uint32_t hash = HashKey(key);
         size_t pos = GetDesiredPosition(hash);
-        int probe_distance = 0;
+        size_t probe_distance = 0;
 
         for (;;)
         {
             if (elements[pos]._hash == 0) {
-                *out_val = nullptr;
                 return false;
             } else if (probe_distance > GetProbeDistance(elements[pos]._hash, pos)) {
                 return false;
             } else if (elements[pos]._hash == hash && elements[pos].key == key) {
-                *out_val = &elements[pos].val;
+                *out_pos = pos;
                 return true;
             }
 
-            pos = (pos + 1) % mask;
+            pos = (pos + 1) & mask;
             ++probe_distance;
         }
     }
@@ -269,9 +459,10 @@ private:
         return cap - 1;
     }
 
+    // Fibonacci hashing: the multiplication by 2^32 / phi spreads every bit of the hash to the top bits.
     size_t GetDesiredPosition(uint32_t hash) const
     {
-        return hash % (cap - 1);
+        return (size_t)((hash * 2654435769u) >> hash_shift);
     }
 
     size_t GetProbeDistance(uint32_t hash, size_t pos) const
@@ -279,18 +470,14 @@ private:
         return (pos + cap - GetDesiredPosition(hash)) & GetMask();
     }
 
-    static bool IsDeleted(uint32_t hash)
-    {
-        return (hash >> 31) != 0;
-    }
-
-    static uint32_t HashKey(const Key& key)
+    template<typename HashedKey>
+    static uint32_t HashKey(const HashedKey& key)
     {
-        std::hash<Key> hasher;
-        size_t untruncated_hash = hasher(key);
-        uint32_t h = static_cast<uint32_t>(untruncated_hash);
+        std::hash<HashedKey> hasher;
+        uint64_t untruncated_hash = (uint64_t)hasher(key);
+        // Fold the upper half, so that 64 bit hashes keep all of their bits.
+        uint32_t h = static_cast<uint32_t>(untruncated_hash ^ (untruncated_hash >> 32));
 
-        h &= 0x7fffffff; // clear MSB (use for deleted marking)
         h |= (h == 0); // hash 0 is used for unused element
 
         return h;
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Han/MallocAllocator.hpp"
+
+// Array with room for N elements inside the container itself. The allocator is only used once more
+// than N elements are added, so small lists (the meshes of a model, the attributes of a vertex
+// layout...) cost no allocation and no pointer chase to a separate block.
+//
+// data always points either to the inline storage or to memory of the allocator, and the elements
+// move with the container when they are inline. Pointers to elements are invalidated by moves.
+template<typename T, size_t N>
+struct SmallArray
+{
+    static_assert(N > 0, "SmallArray should have inline storage, use Array otherwise");
+
+    using Iterator = T*;
+    using ConstIterator = const T*;
+public:
+    SmallArray()
+        : SmallArray(MallocAllocator::Instance())
+    {}
+
+    explicit SmallArray(Allocator* allocator)
+        : allocator(allocator)
+        , len(0)
+        , cap(N)
+        , data(GetInlineData())
+    {}
+
+    SmallArray(Allocator* allocator, const std::initializer_list<T>& init_list)
+        : SmallArray(allocator)
+    {
+        Reserve(init_list.size());
+        for (const auto& el : init_list) {
+            PushBack(el);
+        }
+    }
+
+    // Copy semantics
+    SmallArray(const SmallArray& arr)
+        : SmallArray(arr.allocator)
+    {
+        *this = arr;
+    }
+
+    SmallArray& operator=(const SmallArray& arr)
+    {
+        if (this == &arr) {
+            return *this;
+        }
+        Clear();
+        allocator = arr.allocator;
+        Reserve(arr.len);
+        for (size_t i = 0; i < arr.len; ++i) {
+            new (data + i) T(arr.data[i]);
+        }
+        len = arr.len;
+        return *this;
+    }
+
+    // Move semantics
+    SmallArray(SmallArray&& arr)
+        : SmallArray(arr.allocator)
+    {
+        *this = std::move(arr);
+    }
+
+    SmallArray& operator=(SmallArray&& arr)
+    {
+        if (this == &arr) {
+            return *this;
+        }
+        Clear();
+        allocator = arr.allocator;
+        if (arr.IsInline()) {
+            // Inline elements cannot be stolen, they are moved one by one.
+            for (size_t i = 0; i < arr.len; ++i) {
+                new (data + i) T(std::move(arr.data[i]));
+                arr.data[i].~T();
+            }
+            len = arr.len;
+            arr.len = 0;
+        } else {
+            data = arr.data;
+            len = arr.len;
+            cap = arr.cap;
+            arr.data = arr.GetInlineData();
+            arr.len = 0;
+            arr.cap = N;
+        }
+        return *this;
+    }
+
+    ~SmallArray() { Clear(); }
+
+    // Destroys the elements and gives the memory back to the allocator when it was used.
+    void Clear()
+    {
+        for (size_t i = 0; i < len; ++i) {
+            data[i].~T();
+        }
+        if (!IsInline()) {
+            allocator->Deallocate(data);
+        }
+        data = GetInlineData();
+        len = 0;
+        cap = N;
+    }
+
+    void PushBack(const T& el) { EmplaceBack(el); }
+
+    void PushBack(T&& el) { EmplaceBack(std::move(el)); }
+
+    // Constructs a new element at the end of the array from args.
+    template<typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        if (len == cap) {
+            // args could point into the array, so the element is built before the array moves.
+            T el(std::forward<Args>(args)...);
+            Resize(cap * 2);
+            return *new (data + len++) T(std::move(el));
+        }
+        return *new (data + len++) T(std::forward<Args>(args)...);
+    }
+
+    // Makes room for at least capacity elements, so that adding up to capacity elements does not allocate.
+    void Reserve(size_t capacity)
+    {
+        if (capacity > cap) {
+            Resize(capacity);
+        }
+    }
+
+    T& operator[](size_t index)
+    {
+        assert(index < len);
+        return data[index];
+    }
+
+    const T& operator[](size_t index) const
+    {
+        assert(index < len);
+        return data[index];
+    }
+
+    size_t GetLen() const { return len; }
+    T* GetData() const { return data; }
+    bool IsEmpty() const { return len == 0; }
+
+    // Whether the elements are stored inside the container rather than in the allocator.
+    bool IsInline() const { return data == GetInlineData(); }
+
+    Iterator begin() const { return data; }
+    Iterator end() const { return data + len; }
+    ConstIterator cbegin() const { return data; }
+    ConstIterator cend() const { return data + len; }
+
+private:
+    T* GetInlineData() const { return (T*)_inline; }
+
+    // Moves the elements to a new block of the allocator with room for new_cap elements.
+    void Resize(size_t new_cap)
+    {
+        assert(allocator && "SmallArray needs an allocator to grow past its inline capacity");
+        const bool was_inline = IsInline();
+        if (!was_inline && allocator->TryExtend(data, cap * sizeof(T), new_cap * sizeof(T))) {
+            cap = new_cap;
+            return;
+        }
+
+        T* new_data = (T*)allocator->Allocate(new_cap * sizeof(T), alignof(T), HAN_ALLOCATION_SITE);
+        assert(new_data);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            memcpy(new_data, data, len * sizeof(T));
+        } else {
+            for (size_t i = 0; i < len; ++i) {
+                new (new_data + i) T(std::move(data[i]));
+                data[i].~T();
+            }
+        }
+        if (!was_inline) {
+            allocator->Deallocate(data);
+        }
+        data = new_data;
+        cap = new_cap;
+    }
+
+public:
+    Allocator* allocator;
+    size_t len;
+    size_t cap;
+    T* data;
+
+private:
+    alignas(T) unsigned char _inline[N * sizeof(T)];
+};
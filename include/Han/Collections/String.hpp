@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Han/Allocator.hpp"
+#include "Han/Hash.hpp"
 #include "Han/MallocAllocator.hpp"
 #include "Han/Collections/StringView.hpp"
 #include <assert.h>
@@ -10,13 +11,16 @@
 
 static constexpr const size_t kStringInitialCapacity = 8;
 static constexpr const float kStringGrowthFactor = 1.5f;
+// Strings of up to kStringInlineCapacity - 1 characters are stored inside the String itself and
+// never touch the allocator. Most map keys, attribute names and tokens fit.
+static constexpr const size_t kStringInlineCapacity = 23;
 
+// The characters are either inline or in memory of the allocator. Both are kept in the same
+// bytes, so a String is only an allocator pointer and 24 bytes of storage. The characters are
+// always null terminated, an empty String points to an empty inline string.
 struct String
 {
     Allocator* allocator;
-    size_t cap;
-    size_t len;
-    char* data;
 
     String()
         : String(MallocAllocator::Instance())
@@ -24,16 +28,12 @@ struct String
 
     explicit String(Allocator* allocator)
         : allocator(allocator)
-        , cap(0)
-        , len(0)
-        , data(nullptr)
-    {}
+    {
+        SetInline(0);
+    }
 
     String(Allocator* allocator, const char* contents)
-        : allocator(allocator)
-        , cap(0)
-        , len(0)
-        , data(nullptr)
+        : String(allocator)
     {
         Append(contents);
     }
@@ -44,10 +44,7 @@ struct String
     }
     
     String(Allocator* allocator, const StringView& contents)
-        : allocator(allocator)
-        , cap(0)
-        , len(0)
-        , data(nullptr)
+        : String(allocator)
     {
         Append(contents);
     }
@@ -65,15 +62,8 @@ struct String
     }
 
     String(String&& str)
-        : allocator(str.allocator)
-		, data(str.data)
-		, len(str.len)
-		, cap(str.cap)
     {
-        str.allocator = nullptr;
-        str.data = nullptr;
-        str.len = 0;
-        str.cap = 0;
+        MoveFields(str);
     }
 
     // Copy assignment
@@ -81,15 +71,23 @@ struct String
     {
         assert(this != &str);
         assert(str.allocator);
-        if (data) {
-            allocator->Deallocate(data);
-        } 
+        FreeHeap();
 
-        ShallowCopyFields(str);
+        allocator = str.allocator;
+        const size_t len = str.GetLen();
         // copy the contents as well
-        data = (char*)allocator->Allocate(str.len + 1);
-        assert(data);
-        memcpy(data, str.data, str.len);
+        char* data;
+        if (len + 1 <= kStringInlineCapacity) {
+            SetInline(len);
+            data = _inline.data;
+        } else {
+            data = (char*)allocator->Allocate(len + 1, alignof(char), HAN_ALLOCATION_SITE);
+            assert(data);
+            SetHeap(data, len, len + 1);
+        }
+        if (len > 0) {
+            memcpy(data, str.GetData(), len);
+        }
         data[len] = '\0';
         return *this;
     }
@@ -99,46 +97,43 @@ struct String
     {
         assert(this != &str);
         this->~String();
-        ShallowCopyFields(str);
-        str.allocator = nullptr;
-        str.data = nullptr;
-        str.len = 0;
-        str.cap = 0;
+        MoveFields(str);
         return *this;
     }
 
     ~String()
     {
-        if (data) {
-            allocator->Deallocate(data);
-        }
-        cap = 0;
-        len = 0;
-        data = nullptr;
+        FreeHeap();
+        SetInline(0);
         allocator = nullptr;
     }
 
-	void Reserve(int capacity)
+    const char* GetData() const { return IsInline() ? _inline.data : _heap.data; }
+    char* GetData() { return IsInline() ? _inline.data : _heap.data; }
+
+    size_t GetLen() const { return IsInline() ? (size_t)(_inline.flags & ~kInlineFlag) : _heap.len; }
+
+	// Makes room for capacity characters, without counting the null terminator.
+	void Reserve(size_t capacity)
 	{
-		Resize(capacity);
+		Resize(capacity + 1);
 	}
 
     String& Append(char character)
     {
-        assert(data);
-        size_t new_len = len + 1;
-        while (new_len > (cap - 1)) {
-			size_t new_cap = (size_t)(cap * kStringGrowthFactor);
-            Resize(new_cap);
+        const size_t len = GetLen();
+        const size_t new_len = len + 1;
+        if (new_len + 1 > GetCap()) {
+            Grow(new_len + 1);
         }
-        assert(cap > len);
+        char* data = GetData();
         data[len] = character;
-        data[len+1] = 0;
-        len = new_len;
+        data[new_len] = 0;
+        SetLen(new_len);
 		return *this;
     }
 
-    String& Append(const String& str) { return Append(str.data, str.len); }
+    String& Append(const String& str) { return Append(str.GetData(), str.GetLen()); }
 
     String& Append(const char* str) { return Append(str, strlen(str)); }
 
@@ -165,83 +160,168 @@ struct String
     String& Append(const char* str, size_t str_len)
     {
         assert(str);
-        if (data) {
-            size_t new_len = len + str_len;
-            while (new_len > (cap - 1)) {
-				size_t new_cap = (size_t)(cap * kStringGrowthFactor);
-                Resize(new_cap);
+        const size_t len = GetLen();
+        const size_t new_len = len + str_len;
+        if (new_len + 1 > GetCap()) {
+            // The first append allocates exactly what is needed, the next ones grow geometrically.
+            if (len > 0) {
+                Grow(new_len + 1);
+            } else {
+                Resize(new_len + 1);
             }
-            memcpy(data + len, str, str_len);
-            len = new_len;
-        } else {
-            data = (char*)allocator->Allocate(str_len + 1);
-            assert(data);
-            memcpy(data, str, str_len);
-            len = str_len;
-            cap = str_len;
         }
-        data[len] = 0; // add null terminator
+        char* data = GetData();
+        memcpy(data + len, str, str_len);
+        data[new_len] = 0; // add null terminator
+        SetLen(new_len);
 		return *this;
     }
 
-    char Back() const { return data[len - 1]; }
+    char Back() const { return GetData()[GetLen() - 1]; }
 
-    char Front() const { return data[0]; }
+    char Front() const { return GetData()[0]; }
 
-    char& operator[](size_t index) { return data[index]; }
+    char& operator[](size_t index) { return GetData()[index]; }
 
-    char operator[](size_t index) const { return data[index]; }
+    char operator[](size_t index) const { return GetData()[index]; }
 
-    bool operator==(const String& str)
+    bool operator==(const String& str) const
     {
-        if (len != str.len) {
+        const size_t len = GetLen();
+        if (len != str.GetLen()) {
             return false;
         }
-        return memcmp(data, str.data, len) == 0;
+        return memcmp(GetData(), str.GetData(), len) == 0;
     }
 
-    bool operator!=(const String& str)
+    bool operator!=(const String& str) const
     {
         return !operator==(str);
     }
     
-    bool IsEmpty() const { return len == 0; }
+    bool IsEmpty() const { return GetLen() == 0; }
 
-    StringView View() const { return StringView(data, len); }
+    StringView View() const { return StringView(GetData(), GetLen()); }
+
+    // Whether the characters are stored inside the String rather than in the allocator.
+    bool IsInline() const { return (_inline.flags & kInlineFlag) != 0; }
 
 private:
-    void Resize(int new_cap)
+    // The last byte of the storage is the same in both modes: 0 for a heap string, the flag and
+    // the length for an inline one.
+    static constexpr uint8_t kInlineFlag = 0x80;
+
+    struct HeapStorage
     {
-		if (new_cap <= cap) {
+        char* data;
+        size_t len;
+        // The size of the allocation, including the null terminator.
+        uint32_t cap;
+        uint8_t padding[3];
+        uint8_t flags;
+    };
+
+    struct InlineStorage
+    {
+        char data[kStringInlineCapacity];
+        uint8_t flags;
+    };
+
+    static_assert(sizeof(HeapStorage) == sizeof(InlineStorage), "The flags should share the last byte");
+
+    size_t GetCap() const { return IsInline() ? kStringInlineCapacity : _heap.cap; }
+
+    void SetLen(size_t len)
+    {
+        if (IsInline()) {
+            _inline.flags = (uint8_t)(kInlineFlag | len);
+        } else {
+            _heap.len = len;
+        }
+    }
+
+    void SetInline(size_t len)
+    {
+        assert(len < kStringInlineCapacity);
+        _inline.data[len] = 0;
+        _inline.flags = (uint8_t)(kInlineFlag | len);
+    }
+
+    void SetHeap(char* data, size_t len, size_t cap)
+    {
+        assert(cap <= UINT32_MAX && "String is too long");
+        _heap.data = data;
+        _heap.len = len;
+        _heap.cap = (uint32_t)cap;
+        _heap.flags = 0;
+    }
+
+    void FreeHeap()
+    {
+        if (!IsInline()) {
+            allocator->Deallocate(_heap.data);
+        }
+    }
+
+    // Grows the capacity by the growth factor, or to min_cap if that is not enough.
+    void Grow(size_t min_cap)
+    {
+        size_t new_cap = (size_t)(GetCap() * kStringGrowthFactor);
+        Resize(new_cap > min_cap ? new_cap : min_cap);
+    }
+
+    // The capacity is the size of the storage, including the null terminator.
+    // The string is extended in place when the allocator allows it.
+    void Resize(size_t new_cap)
+    {
+		if (new_cap <= GetCap()) {
 			return;
 		}
 
-        // Need to allocate more memory
-        char* new_data = (char*)allocator->Allocate(new_cap);
+        const size_t len = GetLen();
+        if (!IsInline()) {
+            char* new_data = (char*)allocator->Reallocate(_heap.data, _heap.cap, len, new_cap, alignof(char), HAN_ALLOCATION_SITE);
+            assert(new_data);
+            new_data[len] = 0;
+            SetHeap(new_data, len, new_cap);
+            return;
+        }
+
+        // The inline storage is full: move to the allocator.
+        char* new_data = (char*)allocator->Allocate(new_cap, alignof(char), HAN_ALLOCATION_SITE);
         assert(new_data);
-        memcpy(new_data, data, len);
+        memcpy(new_data, _inline.data, len);
         new_data[len] = 0;
-        allocator->Deallocate(data);
-        data = new_data;
-        cap = new_cap;
+        SetHeap(new_data, len, new_cap);
     }
 
-    void ShallowCopyFields(const String& str)
+    // Takes the contents of str, which is left empty. Neither mode points into the String, so the
+    // storage is copied as it is.
+    void MoveFields(String& str)
     {
         allocator = str.allocator;
-        cap = str.cap;
-        len = str.len;
-        data = str.data;
+        memcpy(&_heap, &str._heap, sizeof(_heap));
+        str.allocator = nullptr;
+        str.SetInline(0);
     }
+
+private:
+    union
+    {
+        HeapStorage _heap;
+        InlineStorage _inline;
+    };
 };
 
+static_assert(sizeof(String) == sizeof(Allocator*) + 24, "String should be an allocator and 24 bytes of storage");
+
 inline bool
 operator==(const String& lhs, const StringView& rhs)
 {
-    if (lhs.len != rhs.len) {
+    if (lhs.GetLen() != rhs.len) {
         return false;
     }
-    return memcmp(lhs.data, rhs.data, rhs.len) == 0;
+    return memcmp(lhs.GetData(), rhs.data, rhs.len) == 0;
 }
 
 inline bool
@@ -262,19 +342,26 @@ operator!=(const StringView& lhs, const String& rhs)
     return !(lhs == rhs);
 }
 
+// String keyed maps can be probed with a StringView (or a C string) without allocating a String.
+template<>
+struct IsTransparentKey<String, StringView> : std::true_type
+{};
+
 namespace std
 {
     template<> struct hash<String>
     {
         size_t operator()(const String& s) const noexcept
         {
-            // http://www.cse.yorku.ca/~oz/hash.html
-            const char* c_str = s.data;
-            size_t h = 5381;
-            int c;
-            while ((c = *c_str++))
-                h = ((h << 5) + h) + c;
-            return h;
+            return HashBytes(s.GetData(), s.GetLen());
+        }
+    };
+
+    template<> struct hash<StringView>
+    {
+        size_t operator()(const StringView& s) const noexcept
+        {
+            return HashBytes(s.data, s.len);
         }
     };
 }
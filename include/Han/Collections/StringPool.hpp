@@ -0,0 +1,136 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+#include "Han/Core.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Han/Collections/StringView.hpp"
+
+// Append only storage for strings. The strings are copied one after the other into big pages, so
+// adding one costs no allocation most of the time and no header per string, only its bytes and a
+// null terminator. Strings never move: the views returned by Add stay valid until the pool is
+// cleared or destroyed. Single strings cannot be freed.
+//
+// The pool is not thread safe, the owner should lock around Add.
+class StringPool
+{
+public:
+    static constexpr size_t kDefaultPageSize = KILOBYTES(16);
+
+    StringPool()
+        : StringPool(MallocAllocator::Instance())
+    {}
+
+    explicit StringPool(Allocator* allocator, size_t page_size = kDefaultPageSize)
+        : _allocator(allocator)
+        , _page_size(page_size)
+        , _pages(nullptr)
+        , _cursor(nullptr)
+        , _end(nullptr)
+        , _bytes_used(0)
+    {}
+
+    StringPool(StringPool&& other)
+        : StringPool(nullptr, 0)
+    {
+        *this = std::move(other);
+    }
+
+    StringPool& operator=(StringPool&& other)
+    {
+        Clear();
+        _allocator = other._allocator;
+        _page_size = other._page_size;
+        _pages = other._pages;
+        _cursor = other._cursor;
+        _end = other._end;
+        _bytes_used = other._bytes_used;
+        other._pages = nullptr;
+        other._cursor = nullptr;
+        other._end = nullptr;
+        other._bytes_used = 0;
+        return *this;
+    }
+
+    ~StringPool() { Clear(); }
+
+    DISABLE_OBJECT_COPY(StringPool);
+
+    // Copies str into the pool. The data of the returned view is null terminated.
+    StringView Add(StringView str)
+    {
+        const size_t size = str.len + 1;
+        char* copy;
+        if ((size_t)(_end - _cursor) >= size) {
+            copy = _cursor;
+            _cursor += size;
+        } else if (sizeof(Page) + size > _page_size) {
+            // Too long for a page: it gets one of its own, linked behind the current page, which
+            // stays open for the next strings.
+            Page* page = AllocatePage(sizeof(Page) + size);
+            if (_pages) {
+                page->next = _pages->next;
+                _pages->next = page;
+            } else {
+                page->next = nullptr;
+                _pages = page;
+            }
+            copy = (char*)(page + 1);
+        } else {
+            Page* page = AllocatePage(_page_size);
+            page->next = _pages;
+            _pages = page;
+            copy = (char*)(page + 1);
+            _cursor = copy + size;
+            _end = (char*)page + _page_size;
+        }
+
+        if (str.len > 0) {
+            memcpy(copy, str.data, str.len);
+        }
+        copy[str.len] = '\0';
+        _bytes_used += size;
+        return StringView(copy, str.len);
+    }
+
+    // Frees every page. The views given out before are dangling.
+    void Clear()
+    {
+        while (_pages) {
+            Page* next = _pages->next;
+            _allocator->Deallocate(_pages);
+            _pages = next;
+        }
+        _cursor = nullptr;
+        _end = nullptr;
+        _bytes_used = 0;
+    }
+
+    // Bytes taken by the strings and their terminators, without the unused end of the pages.
+    size_t GetBytesUsed() const { return _bytes_used; }
+
+private:
+    struct Page
+    {
+        Page* next;
+    };
+
+    Page* AllocatePage(size_t size)
+    {
+        assert(_allocator);
+        Page* page = (Page*)_allocator->Allocate(size, alignof(Page), HAN_ALLOCATION_SITE);
+        assert(page);
+        return page;
+    }
+
+private:
+    Allocator* _allocator;
+    size_t _page_size;
+    // The newest page first, strings are added at its cursor. The pages of long strings follow it.
+    Page* _pages;
+    char* _cursor;
+    char* _end;
+    size_t _bytes_used;
+};
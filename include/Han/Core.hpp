@@ -44,7 +44,7 @@
 #define PLATFORM_UNIX 1
 #endif
 
-#if defined(__x86_64__) || defined(_M_X86) || defined(__i386__)
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_IX86) || defined(__i386__)
 #define ARCH_X86 1
 #endif
 
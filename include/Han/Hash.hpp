@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// 64 bit string hash in the style of wyhash: the input is consumed 16 bytes at a time and every
+// step is a 64x64->128 bit multiplication folded back to 64 bits. Short strings (most Sids and map
+// keys) take one or two reads.
+//
+// Everything is constexpr, so that Sids made from literals can be hashed at compile time. The reads
+// assemble the bytes with shifts, which compilers turn into plain loads.
+//
+// Based on wyhash by Wang Yi (public domain). The output is not compatible with it.
+namespace HashDetail
+{
+    static constexpr uint64_t kSecret0 = 0xa0761d6478bd642full;
+    static constexpr uint64_t kSecret1 = 0xe7037ed1a0b428dbull;
+    static constexpr uint64_t kSecret2 = 0x8ebc6af09c88c6e3ull;
+
+    // Returns the low and high halves of the 128 bit product of a and b.
+    constexpr void
+    Multiply(uint64_t a, uint64_t b, uint64_t* lo, uint64_t* hi)
+    {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 r = (unsigned __int128)a * b;
+        *lo = (uint64_t)r;
+        *hi = (uint64_t)(r >> 64);
+#else
+        const uint64_t a_lo = a & 0xffffffffull, a_hi = a >> 32;
+        const uint64_t b_lo = b & 0xffffffffull, b_hi = b >> 32;
+        const uint64_t lo_lo = a_lo * b_lo;
+        const uint64_t hi_lo = a_hi * b_lo;
+        const uint64_t lo_hi = a_lo * b_hi;
+        const uint64_t hi_hi = a_hi * b_hi;
+        const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffull) + lo_hi;
+        *lo = (cross << 32) | (lo_lo & 0xffffffffull);
+        *hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+    }
+
+    constexpr uint64_t
+    Mix(uint64_t a, uint64_t b)
+    {
+        uint64_t lo = 0, hi = 0;
+        Multiply(a, b, &lo, &hi);
+        return lo ^ hi;
+    }
+
+    // Little endian reads of 8, 4 and 1-3 bytes.
+    constexpr uint64_t
+    Read8(const char* p)
+    {
+        return (uint64_t)(uint8_t)p[0] | (uint64_t)(uint8_t)p[1] << 8 | (uint64_t)(uint8_t)p[2] << 16 |
+               (uint64_t)(uint8_t)p[3] << 24 | (uint64_t)(uint8_t)p[4] << 32 | (uint64_t)(uint8_t)p[5] << 40 |
+               (uint64_t)(uint8_t)p[6] << 48 | (uint64_t)(uint8_t)p[7] << 56;
+    }
+
+    constexpr uint64_t
+    Read4(const char* p)
+    {
+        return (uint64_t)(uint8_t)p[0] | (uint64_t)(uint8_t)p[1] << 8 | (uint64_t)(uint8_t)p[2] << 16 |
+               (uint64_t)(uint8_t)p[3] << 24;
+    }
+
+    constexpr uint64_t
+    Read3(const char* p, size_t len)
+    {
+        return (uint64_t)(uint8_t)p[0] << 16 | (uint64_t)(uint8_t)p[len >> 1] << 8 | (uint64_t)(uint8_t)p[len - 1];
+    }
+}
+
+constexpr uint64_t
+HashString(const char* data, size_t len, uint64_t seed = 0)
+{
+    using namespace HashDetail;
+
+    seed ^= Mix(seed ^ kSecret0, kSecret1);
+    uint64_t a = 0, b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            // Two overlapping reads cover every byte of strings of 4 to 16 bytes.
+            const size_t offset = (len >> 3) << 2;
+            a = (Read4(data) << 32) | Read4(data + offset);
+            b = (Read4(data + len - 4) << 32) | Read4(data + len - 4 - offset);
+        } else if (len > 0) {
+            a = Read3(data, len);
+        }
+    } else {
+        const char* p = data;
+        size_t remaining = len;
+        while (remaining > 16) {
+            seed = Mix(Read8(p) ^ kSecret1, Read8(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        // The last 16 bytes, which can overlap with the previous step.
+        a = Read8(p + remaining - 16);
+        b = Read8(p + remaining - 8);
+    }
+
+    a ^= kSecret1;
+    b ^= seed;
+    uint64_t lo = 0, hi = 0;
+    Multiply(a, b, &lo, &hi);
+    return Mix(lo ^ kSecret0 ^ len, hi ^ kSecret1);
+}
+
+constexpr size_t
+StringLength(const char* str)
+{
+    size_t len = 0;
+    while (str[len]) {
+        ++len;
+    }
+    return len;
+}
+
+// Hashes len bytes of data. Every string type (String, StringView) hashes its characters with it,
+// so that equal strings have the same hash whatever type holds them.
+inline size_t
+HashBytes(const void* data, size_t len)
+{
+    return (size_t)HashString((const char*)data, len);
+}
+
+// Tells the hash maps that a LookupKey can be used to find a Key without building a Key.
+// Both should be comparable with ==, and equal values should have the same std::hash.
+template<typename Key, typename LookupKey>
+struct IsTransparentKey : std::false_type
+{};
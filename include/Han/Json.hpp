@@ -2,9 +2,8 @@
 
 #include <stdint.h>
 #include "Han/Allocator.hpp"
-#include "Han/Collections/RobinHashMap.hpp"
-#include "Han/Collections/Array.hpp"
 #include "Han/Collections/String.hpp"
+#include "Han/Collections/StringView.hpp"
 
 namespace Json {
 
@@ -19,139 +18,117 @@ enum class Type
     Null,
 };
 
+struct Val;
+struct Member;
+
+// The values of a json array. The memory belongs to the document.
+struct ArrayView
+{
+    const Val* data;
+    size_t len;
+
+    const Val& operator[](size_t index) const;
+
+    const Val* begin() const { return data; }
+    const Val* end() const;
+};
+
+// The members of a json object, in the order of the document. The memory belongs to the document.
+// Small objects are searched linearly. Bigger ones also get an open addressing index of their
+// members, stored right after them.
+struct Object
+{
+    // Objects with more members than this get an index.
+    static constexpr uint32_t kMaxLinearSearchLen = 8;
+
+    const Member* members;
+    uint32_t len;
+    // Power of two, or 0 when the object has no index.
+    uint32_t index_cap;
+
+    const Val* Find(StringView key) const;
+    const Val* Find(const char* key) const { return Find(StringView(key)); }
+
+    const Member* begin() const { return members; }
+    const Member* end() const;
+
+    // Returns the slots of the index. Every slot holds the position of a member plus one, or 0.
+    const uint32_t* GetIndex() const;
+};
+
+// A json value. Values do not own memory: strings point into the parsed text, arrays and objects
+// into the memory of their document, so values are just copied around.
 struct Val
 {
     Type type;
-    
+
     union TypeValues
     {
-        String string;
+        StringView string;
         int64_t integer;
         double real;
-        Array<Val> array;
-        RobinHashMap<String, Val> object;
+        ArrayView array;
+        Object object;
         bool boolean;
 
         TypeValues(): integer(0) {}
-        ~TypeValues() {}
     } values;
-    
-    Val(String str)
-        : type(Type::String)
-    {
-        memset(&values, 0, sizeof(TypeValues));
-        values.string = std::move(str);
-    }
-    
+
     Val()
         : type(Type::Null)
+    {}
+
+    explicit Val(StringView str)
+        : type(Type::String)
     {
+        values.string = str;
     }
-    
-    Val(double real)
+
+    explicit Val(double real)
         : type(Type::Real)
     {
         values.real = real;
     }
 
-    Val(bool val)
+    explicit Val(bool val)
         : type(Type::Boolean)
     {
         values.boolean = val;
     }
-    
-    Val(int64_t integer)
+
+    explicit Val(int64_t integer)
         : type(Type::Integer)
     {
         values.integer = integer;
     }
 
-    Val(RobinHashMap<String, Val> val)
+    explicit Val(Object object)
         : type(Type::Object)
     {
-        memset(&values, 0, sizeof(TypeValues));
-        values.object = std::move(val);
+        values.object = object;
     }
 
-    Val(Array<Val> array)
+    explicit Val(ArrayView array)
         : type(Type::Array)
     {
-        memset(&values, 0, sizeof(TypeValues));
-        values.array = std::move(array);
-    }
-
-    ~Val()
-    {
-        switch (type) {
-            case Type::Array:
-                values.array.~Array();
-                break;
-            case Type::Object:
-                values.object.~RobinHashMap();
-                break;
-            case Type::String:
-                values.string.~String();
-                break;
-            default:
-                // ignore
-                break;
-        }
-    }
-
-    // move operators
-    Val(Val&& other)
-    {
-        memset(&values, 0, sizeof(TypeValues));
-        *this = std::move(other);
-    }
-
-    Val& operator=(Val&& other)
-    {
-        ResetUnion();
-        type = other.type;
-
-        switch (other.type) {
-            case Type::Integer:
-                values.integer = other.values.integer;
-                break;
-            case Type::Real:
-                values.real = other.values.real;
-                break;
-            case Type::String:
-                values.string = std::move(other.values.string);
-                break;
-            case Type::Object:
-                values.object = std::move(other.values.object);
-                break;
-            case Type::Boolean:
-                values.boolean = other.values.boolean;
-                break;
-            case Type::Array:
-                values.array = std::move(other.values.array);
-                break;
-            case Type::Null:
-                // do nothing
-                break;
-        }
-
-        other.type = Type::Null;
-        return *this;
+        values.array = array;
     }
 
     bool IsString() const { return type == Type::String; }
-    const String* AsString() const
+    // The string is not null terminated, and escape sequences are kept as they are in the text.
+    const StringView* AsString() const
     {
         return type == Type::String ? &values.string : nullptr;
     }
 
     bool IsObject() const { return type == Type::Object; }
-    const RobinHashMap<String, Val>* AsObject() const
+    const Object* AsObject() const
     {
         return type == Type::Object ? &values.object : nullptr;
     }
 
     bool IsArray() const { return type == Type::Array; }
-    const Array<Val>* AsArray() const
+    const ArrayView* AsArray() const
     {
         return type == Type::Array ? &values.array : nullptr;
     }
@@ -201,28 +178,42 @@ struct Val
     }
 
     String PrettyPrint(Allocator* other_allocator = nullptr) const;
+};
 
-private:
-    void ResetUnion()
-    {
-        switch (type) {
-            case Type::String:
-                values.string.~String();
-                break;
-            case Type::Object:
-                values.object.~RobinHashMap();
-                break;
-            case Type::Array:
-                values.array.~Array();
-                break;
-            default:
-                // do nothing
-                break;
-        }
-        memset(&values, 0, sizeof(TypeValues));
-    }
+struct Member
+{
+    StringView key;
+    Val val;
 };
 
+inline const Val&
+ArrayView::operator[](size_t index) const
+{
+    assert(index < len);
+    return data[index];
+}
+
+inline const Val*
+ArrayView::end() const
+{
+    return data + len;
+}
+
+inline const Member*
+Object::end() const
+{
+    return members + len;
+}
+
+inline const uint32_t*
+Object::GetIndex() const
+{
+    return (const uint32_t*)(members + len);
+}
+
+// Holds the values of a parsed json text. The arrays and objects are allocated in big blocks that
+// are freed together with the document, so parsing takes a few allocations whatever the size of
+// the text. The values are only valid as long as the document (and the text, see ParseInSitu).
 struct Document
 {
     Allocator* allocator;
@@ -232,14 +223,43 @@ struct Document
     Document(Allocator* allocator)
         : allocator(allocator)
         , root_val()
+        , _blocks(nullptr)
+        , _cursor(nullptr)
+        , _end(nullptr)
     {}
 
+    ~Document();
+
+    DISABLE_OBJECT_COPY_AND_MOVE(Document);
+
+    // Copies the text into the document first, so it can be freed right after parsing.
     void Parse(const char* json_str);
-    void Parse(uint8_t* data, size_t size);
+    void Parse(const uint8_t* data, size_t size);
+
+    // Parses without copying the text: the strings of the values point into data, which should
+    // stay alive (and unchanged) as long as the values are used.
+    void ParseInSitu(const uint8_t* data, size_t size);
+
     bool HasParseErrors() const { return !parse_error.IsEmpty(); }
-    const char* GetErrorStr() const { return parse_error.data; }
+    const char* GetErrorStr() const { return parse_error.GetData(); }
     String PrettyPrint(Allocator* other_allocator = nullptr) const;
+
+    // Memory for the values of the document, freed with it. Returns null when the allocator is out of memory.
+    void* AllocateBlock(size_t size, size_t alignment);
+
+private:
+    struct Block
+    {
+        Block* next;
+        size_t size;
+    };
+
+    static constexpr size_t kMinBlockSize = KILOBYTES(64);
+    static constexpr size_t kMaxBlockSize = MEGABYTES(4);
+
+    Block* _blocks;
+    uint8_t* _cursor;
+    uint8_t* _end;
 };
 
 }
-
@@ -11,8 +11,9 @@ class LinearAllocator : public Allocator
 {
 public:
     LinearAllocator()
-        : _bytes_allocated(0)
-        , _mem(nullptr)
+        : _mem(nullptr)
+        , _bytes_allocated(0)
+        , _last_allocation_start(kNoAllocation)
         , _size(0)
         , _name(nullptr)
     {}
@@ -28,6 +29,7 @@ public:
     LinearAllocator(const char* name, void* mem, size_t size)
         : _mem(mem)
         , _bytes_allocated(0)
+        , _last_allocation_start(kNoAllocation)
         , _size(size)
         , _name(name)
     {
@@ -50,50 +52,88 @@ public:
         _size = a._size;
         _name = a._name;
         _bytes_allocated = a._bytes_allocated;
+        _last_allocation_start = a._last_allocation_start;
         a._mem = nullptr;
         a._size = 0;
         a._name = nullptr;
         a._bytes_allocated = 0;
+        a._last_allocation_start = kNoAllocation;
         return *this;
     }
 
-    void* Allocate(size_t size) override
+	size_t GetAllocatedBytes() const override { return _bytes_allocated; }
+
+    const char* GetName() const override { return _name; }
+
+	size_t GetSize() const override { return _size; }
+
+	AllocatorType GetType() const override { return AllocatorType::Linear; }
+
+    void Clear()
+    {
+        ReleaseRange(_mem, (uint8_t*)_mem + _bytes_allocated);
+        _bytes_allocated = 0;
+        _last_allocation_start = kNoAllocation;
+    }
+
+protected:
+    void* DoAllocate(size_t size, size_t alignment) override
     {
         ASSERT(_mem, "Allocator should be initialized");
+        ASSERT(IsPowerOfTwo(alignment), "Alignment should be a power of two");
 
-        if (size > _size - _bytes_allocated) {
+        const uintptr_t current = (uintptr_t)_mem + _bytes_allocated;
+        const size_t padding = AlignForward(current, alignment) - current;
+
+        if (padding + size > _size - _bytes_allocated) {
             LOG_WARN("Cannot allocate %s memory in %s allocator (size of %s)",
-                     Utils::GetPrettySize(size).data,
+                     Utils::GetPrettySize(size).GetData(),
                      _name,
-                     Utils::GetPrettySize(_size).data);
+                     Utils::GetPrettySize(_size).GetData());
             return nullptr;
         }
 
-        void* free_mem = (void*)((uint8_t*)_mem + _bytes_allocated);
+        void* free_mem = (void*)(current + padding);
 		ASSERT(free_mem, "Memory allocation should not fail");
-        _bytes_allocated += size;
+        _last_allocation_start = _bytes_allocated + padding;
+        _bytes_allocated += padding + size;
 
         return free_mem;
     }
 
-    void Deallocate(void* ptr) override
+    void DoDeallocate(void* ptr) override
     { /* Do nothing */
         (void)ptr;
     }
 
-	size_t GetAllocatedBytes() const override { return _bytes_allocated; }
-
-    const char* GetName() const override { return _name; }
+    // Only the last allocation can be resized, by moving the top of the arena. It is matched by
+    // its start rather than by its end, since a zero sized allocation ends where the block before
+    // it ends.
+    bool DoTryExtend(void* ptr, size_t old_size, size_t new_size) override
+    {
+        const size_t offset = _last_allocation_start;
+        if (offset == kNoAllocation
+            || ptr != (uint8_t*)_mem + offset
+            || offset + old_size != _bytes_allocated) {
+            return false;
+        }
 
-	size_t GetSize() const override { return _size; }
+        if (new_size > _size - offset) {
+            return false;
+        }
 
-	AllocatorType GetType() const override { return AllocatorType::Linear; }
+        _bytes_allocated = offset + new_size;
+        return true;
+    }
 
-    void Clear() { _bytes_allocated = 0; }
+private:
+    static constexpr size_t kNoAllocation = (size_t)-1;
 
 private:
     void* _mem;
     size_t _bytes_allocated;
+    // Offset of the memory returned by the last allocation, after the alignment padding.
+    size_t _last_allocation_start;
     size_t _size;
     const char* _name;
 };
@@ -2,9 +2,12 @@
 
 #include "Han/Core.hpp"
 #include "Han/Allocator.hpp"
+#include <atomic>
 #include <limits>
 #include <stdint.h>
 
+// Allocates memory with malloc. It can be used from several threads at the same time, since the
+// accounting is done with atomics.
 class MallocAllocator : public Allocator
 {
 public:
@@ -19,48 +22,68 @@ public:
     {
     }
 
-    void* Allocate(size_t size) override
+    const char* GetName() const override { return _name; }
+
+    size_t GetBytesWaterMark() const { return _bytes_water_mark.load(std::memory_order_relaxed); }
+	size_t GetAllocatedBytes() const override { return _bytes_allocated.load(std::memory_order_relaxed); }
+
+	// Malloc allocators have no size, since the amount of memory is only bounded
+	// by the operating system.
+	size_t GetSize() const override { return 0; }
+	AllocatorType GetType() const override { return AllocatorType::Malloc; }
+
+	static Allocator* Instance()
+	{
+		// The instance is never destroyed, since objects with static storage duration
+		// can still deallocate memory with it when they are destroyed.
+		alignas(MallocAllocator) static uint8_t storage[sizeof(MallocAllocator)];
+		static MallocAllocator* alloc = ::new (storage) MallocAllocator();
+		return alloc;
+	}
+
+protected:
+    void* DoAllocate(size_t size, size_t alignment) override
     {
 		ASSERT(size >= 0 && size <= std::numeric_limits<int32_t>::max(), "Allocation should be within bounds");
-		size_t size_with_header = size + sizeof(int32_t);
+		ASSERT(IsPowerOfTwo(alignment), "Alignment should be a power of two");
+
+		// The header has to be aligned as well, since it sits right before the returned memory.
+		alignment = HAN_MAX(alignment, alignof(Header));
+		size_t size_with_header = size + sizeof(Header) + alignment - 1;
         void* new_mem = malloc(size_with_header);
         ASSERT(new_mem, "Not enough memory");
 
+		uintptr_t user_mem = AlignForward((uintptr_t)new_mem + sizeof(Header), alignment);
+
 		// write header
-		*((int32_t*)new_mem) = size;
-        _bytes_water_mark += size;
-		_bytes_allocated += size;
-        return (int32_t*)new_mem + 1;
+		Header* header = (Header*)user_mem - 1;
+		header->size = (int32_t)size;
+		header->offset = (int32_t)(user_mem - (uintptr_t)new_mem);
+		_bytes_water_mark.fetch_add(size, std::memory_order_relaxed);
+		_bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+        return (void*)user_mem;
     }
 
-    void Deallocate(void* ptr) override
+    void DoDeallocate(void* ptr) override
 	{
 		if (ptr) {
-			void* header = (int32_t*)ptr - 1;
-			int32_t size = *((int32_t*)header);
-			_bytes_allocated -= size;
-			free(header);
+			Header* header = (Header*)ptr - 1;
+			_bytes_allocated.fetch_sub(header->size, std::memory_order_relaxed);
+			free((uint8_t*)ptr - header->offset);
 		}
 	}
 
-    const char* GetName() const override { return _name; }
-
-    size_t GetBytesWaterMark() const { return _bytes_water_mark; }
-	size_t GetAllocatedBytes() const override { return _bytes_allocated; }
-
-	// Malloc allocators have no size, since the amount of memory is only bounded
-	// by the operating system.
-	size_t GetSize() const override { return 0; }
-	AllocatorType GetType() const override { return AllocatorType::Malloc; }
-
-	static Allocator* Instance()
+private:
+	// Stored right before every allocation.
+	struct Header
 	{
-		static MallocAllocator alloc;
-		return &alloc;
-	}
+		int32_t size;
+		// Distance from the start of the malloc'ed block to the returned memory.
+		int32_t offset;
+	};
 
 private:
-    size_t _bytes_water_mark;
-	size_t _bytes_allocated;
+    std::atomic<size_t> _bytes_water_mark;
+	std::atomic<size_t> _bytes_allocated;
     const char* _name;
 };
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Han/Core.hpp"
-#include "Han/Collections/Array.hpp"
+#include "Han/Collections/SmallArray.hpp"
 #include "Han/Math/Vec3.hpp"
 #include "Han/Math/Quaternion.hpp"
 #include "TriangleMesh.hpp"
@@ -12,7 +12,8 @@ struct Model
     // a model and a model instance. A model instance will be a light weight model
     // with orientation, scale, etc.
     Sid name;
-    Array<TriangleMesh*> meshes;
+    // The meshes belong to the resource manager.
+    SmallArray<MeshHandle, 8> meshes;
     Vec3 translation;
     Quaternion rotation;
     float scale;
@@ -9,7 +9,13 @@
 #include "Han/Shader.hpp"
 #include "Model.hpp"
 
+struct ResourceManager;
+
+// The materials of the submeshes (and the meshes of the model) are resolved in resources. The ones
+// that were unloaded are skipped.
+
 void RenderMesh(const TriangleMesh& mesh,
+                const ResourceManager& resources,
                 const Shader& shader,
                 Vec3 position,
                 Quaternion orientation,
@@ -17,6 +23,7 @@ void RenderMesh(const TriangleMesh& mesh,
                 Vec4* scale_color = nullptr);
 
 void RenderModel(const Model& model,
+                 const ResourceManager& resources,
                  const Shader& shader,
                  Vec3 position,
                  Quaternion orientation,
@@ -3,7 +3,7 @@
 #include <stdint.h>
 #include <initializer_list>
 #include "Han/Allocator.hpp"
-#include "Han/Collections/Array.hpp"
+#include "Han/Collections/SmallArray.hpp"
 
 //
 // This file is based on the Hazel engine.
@@ -34,6 +34,9 @@ private:
 
 class BufferLayout
 {
+    // Layouts rarely have more than a handful of attributes, so they are kept inline.
+    using ElementArray = SmallArray<BufferLayoutElement, 8>;
+
 public:
     BufferLayout()
         : _stride(0)
@@ -44,14 +47,14 @@ public:
     size_t Stride() const { return _stride; }
     size_t ElementCount() const { return _elements.len; }
 
-    Array<BufferLayoutElement>::Iterator begin() const { return _elements.begin(); }
-    Array<BufferLayoutElement>::Iterator end() const { return _elements.end(); }
+    ElementArray::Iterator begin() const { return _elements.begin(); }
+    ElementArray::Iterator end() const { return _elements.end(); }
 
     const BufferLayoutElement& operator[](size_t index) const { return _elements[index]; }
 
 private:
     size_t _stride;
-    Array<BufferLayoutElement> _elements;
+    ElementArray _elements;
 };
 
 class VertexBuffer
@@ -3,6 +3,7 @@
 #include "Han/Math/Vec3.hpp"
 #include "Han/Math/Vec4.hpp"
 #include "Han/Math/Mat4.hpp"
+#include "Han/Collections/FlatHashMap.hpp"
 #include "Han/Texture.hpp"
 
 // This enumeration specifies how a material should be rendered.
@@ -42,11 +43,11 @@ public:
         , _float(f)
     {}
 
-    MaterialValue(Texture* tex)
+    MaterialValue(TextureHandle tex)
         : _kind(Kind::Texture)
     {
-        ASSERT(tex, "tex is null!");
-        _texture.ptr = tex;
+        ASSERT(tex.IsValid(), "tex is invalid!");
+        _texture.handle = tex;
         _texture.shader_index = -1;
     }
 
@@ -55,7 +56,7 @@ public:
     Vec4 GetVec4() const { return _vec4; }
     Mat4 GetMat4() const { return _mat4; }
     float GetFloat() const { return _float; }
-    Texture* GetTexture() const { return _texture.ptr; }
+    TextureHandle GetTexture() const { return _texture.handle; }
     int GetTextureIndex() const { return _texture.shader_index; }
 private:
     Kind _kind;
@@ -67,7 +68,7 @@ private:
         float _float;
         struct
         {
-            Texture* ptr;
+            TextureHandle handle;
             int shader_index;
         } _texture;
     };
@@ -78,20 +79,20 @@ struct Material
 {
 public:
     Sid name;
-    IlluminationModel illumination_model;
+    IlluminationModel illumination_model = IlluminationModel::Color;
 
     Vec3 diffuse_color = Vec3::Zero();
     Vec3 ambient_color = Vec3::Zero();
     Vec3 specular_color = Vec3::Zero();
     float shininess = 0.0f;
     Shader* shader = nullptr;
-    RobinHashMap<Sid, MaterialValue> values;
+    FlatHashMap<Sid, MaterialValue> values;
 private:
     int _next_index = 0;
 
 public:
 
-    Material(Allocator* allocator)
+    explicit Material(Allocator* allocator)
         : values(allocator, 16)
         , _next_index(0)
     {}
@@ -105,7 +106,8 @@ public:
         values.Add(name, val);
     }
 
-    void Bind()
+    // The texture values are resolved in textures. Unloaded textures are skipped.
+    void Bind(const TexturePool& textures) const
     {
         ASSERT(shader, "shader is null!");
         for (const auto& pair : values) {
@@ -119,9 +121,13 @@ public:
                 case MaterialValue::Kind::Mat4:
                     shader->SetUniformMat4(pair.key, pair.val.GetMat4());
                     break;
-                case MaterialValue::Kind::Texture:
-                    shader->SetTexture2d(pair.key, pair.val.GetTexture(), pair.val.GetTextureIndex());
+                case MaterialValue::Kind::Texture: {
+                    const Texture* texture = textures.Get(pair.val.GetTexture());
+                    if (texture) {
+                        shader->SetTexture2d(pair.key, texture, pair.val.GetTextureIndex());
+                    }
                     break;
+                }
                 case MaterialValue::Kind::Float:
                     shader->SetFloat(pair.key, pair.val.GetFloat());
                     break;
@@ -133,3 +139,5 @@ public:
     }
 };
 
+using MaterialHandle = Handle<Material>;
+using MaterialPool = HandlePool<Material>;
@@ -105,7 +105,8 @@ struct ResourceFile
         assert(_scratch_allocator == nullptr);
     }
 
-    void Create(const Sid& sid);
+    // file is relative to the resources folder.
+    void Create(const char* file);
     void Destroy();
 
 	inline bool Has(const String& key) const
@@ -115,12 +116,16 @@ struct ResourceFile
 
 	inline bool Has(const StringView& key) const
 	{
-        String wrapper(_scratch_allocator, key.data);
-        return _entries.Find(std::move(wrapper)) != nullptr;
+        return _entries.Find(key) != nullptr;
 	}
 
 	template<typename T> const T* Get(const String& key) const
 	{
+        return Get<T>(key.View());
+	}
+
+	template<typename T> const T* Get(const StringView& key) const
+	{
         const auto* it = _entries.Find(key);
         if (it) {
             // TODO: usign dynamic_cast here means that we cannot compile the 
@@ -134,12 +139,6 @@ struct ResourceFile
         }
 	}
 
-	template<typename T> const T* Get(const StringView& key) const
-	{
-        String wrapper(_scratch_allocator, key.data);
-		return Get<T>(std::move(wrapper));
-	}
-
     RobinHashMap<String, Val*>& GetEntries() { return _entries; }
     const RobinHashMap<String, Val*>& GetEntries() const { return _entries; }
 
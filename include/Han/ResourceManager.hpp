@@ -3,6 +3,7 @@
 #include "Han/Allocator.hpp"
 #include "Han/Collections/Array.hpp"
 #include "Han/Core.hpp"
+#include "Han/StackAllocator.hpp"
 #include "Han/Math/Quaternion.hpp"
 #include "Han/Sid.hpp"
 #include "Han/Path.hpp"
@@ -21,14 +22,24 @@ enum LoadTextureFlags
 
 struct ResourceManager
 {
+    // Holds the resources and their buffers. It should be able to free, so that unloading a
+    // resource gives its memory back.
     Allocator* allocator;
-    Allocator* scratch_allocator;
+    // Temporary memory used while loading resources. Every load frees what it used from the stack
+    // when it is done.
+    StackAllocator* scratch_allocator;
     Path resources_path;
 
-    RobinHashMap<Sid, Texture*> textures;
+    // Textures, materials and meshes are stored packed in handle pools and looked up by name
+    // through their *_handles map. Handles stay valid when other resources are loaded or unloaded,
+    // pointers to the resources do not.
+    TexturePool textures;
+    RobinHashMap<Sid, TextureHandle> texture_handles;
+    MaterialPool materials;
+    RobinHashMap<Sid, MaterialHandle> material_handles;
+    MeshPool meshes;
+    RobinHashMap<Sid, MeshHandle> mesh_handles;
     RobinHashMap<Sid, Shader*> shaders;
-    RobinHashMap<Sid, TriangleMesh*> meshes;
-    RobinHashMap<Sid, Material*> materials;
 
 public:
     static constexpr int kNumMeshes = 32;
@@ -36,14 +47,17 @@ public:
     static constexpr int kNumShaders = 32;
     static constexpr int kNumMaterials = 32;
 
-    ResourceManager(Allocator* allocator, Allocator* scratch_allocator)
+    ResourceManager(Allocator* allocator, StackAllocator* scratch_allocator)
         : allocator(allocator)
         , scratch_allocator(scratch_allocator)
         , resources_path(allocator)
         , textures(allocator, kNumTextures)
-        , shaders(allocator, kNumShaders)
-        , meshes(allocator, kNumMeshes)
+        , texture_handles(allocator, kNumTextures)
         , materials(allocator, kNumMaterials)
+        , material_handles(allocator, kNumMaterials)
+        , meshes(allocator, kNumMeshes)
+        , mesh_handles(allocator, kNumMeshes)
+        , shaders(allocator, kNumShaders)
     {}
 
     ResourceManager(ResourceManager&& other) = default;
@@ -53,23 +67,69 @@ public:
     void Create();
     void Destroy();
 
-    Texture* LoadTexture(const Sid& texture_file, int flags = LoadTextureFlags_None);
-    Texture* GetTexture(const Sid& texture_file)
+    // Resources are loaded from a file relative to the resources folder, and registered under
+    // SID(file). The file names are passed as strings, since Sids do not keep their string in
+    // shipping builds.
+    TextureHandle LoadTexture(const char* texture_file, int flags = LoadTextureFlags_None);
+    // Returns an invalid handle when the texture is not loaded.
+    TextureHandle FindTexture(const Sid& texture_file) const
+    {
+        const TextureHandle* handle = texture_handles.Find(texture_file);
+        return handle ? *handle : TextureHandle{};
+    }
+    // Returns null when the texture was unloaded. The pointer is valid until the next texture is
+    // loaded or unloaded.
+    Texture* GetTexture(TextureHandle texture)
+    {
+        return textures.Get(texture);
+    }
+
+    // Adds an empty material that renders with shader. A material that was registered under the
+    // same name is unloaded first. The pointer given by GetMaterial is valid until the next
+    // material is created or unloaded.
+    MaterialHandle CreateMaterial(const Sid& material_name, Shader* shader);
+    // Returns an invalid handle when there is no material with that name.
+    MaterialHandle FindMaterial(const Sid& material_name) const
     {
-        return *textures.Find(texture_file);
+        const MaterialHandle* handle = material_handles.Find(material_name);
+        return handle ? *handle : MaterialHandle{};
     }
+    // Returns null when the material was unloaded.
+    Material* GetMaterial(MaterialHandle material) { return materials.Get(material); }
+    const Material* GetMaterial(MaterialHandle material) const { return materials.Get(material); }
 
-    Material* GetMaterial(const Sid& material_name)
+    // Meshes are registered under their name: the obj file, or the name of the mesh in the gltf file.
+    // Like materials, a mesh that was registered under the same name is unloaded first, so loading
+    // a model again leaves the meshes of the previous load unresolved.
+    MeshHandle CreateMesh(const Sid& mesh_name);
+    MeshHandle FindMesh(const Sid& mesh_name) const
     {
-        return *materials.Find(material_name);
+        const MeshHandle* handle = mesh_handles.Find(mesh_name);
+        return handle ? *handle : MeshHandle{};
     }
+    // Returns null when the mesh was unloaded. The pointer is valid until the next mesh is loaded
+    // or unloaded.
+    TriangleMesh* GetMesh(MeshHandle mesh) { return meshes.Get(mesh); }
+    const TriangleMesh* GetMesh(MeshHandle mesh) const { return meshes.Get(mesh); }
+
+    // Unloading destroys the resource and frees its memory. Handles to textures, materials and
+    // meshes stop resolving: materials skip the textures that were unloaded, and meshes the
+    // materials. Anything that still uses a shader should be unloaded first.
+    // Returns false when the resource is not loaded.
+    bool UnloadTexture(const Sid& texture_file);
+    bool UnloadMaterial(const Sid& material_name);
+    bool UnloadShader(const Sid& shader_file);
+    bool UnloadMesh(const Sid& mesh_name);
+    // Unloads every mesh of the model. The materials and textures are shared, so they stay loaded.
+    void UnloadModel(Model* model);
 
-    Model LoadModel(const Sid& model_file);
+    Model LoadModel(const char* model_file);
 
     Model LoadObjModel(const ResourceFile& res_file);
     Model LoadGltfModel(const ResourceFile& res_file);
 
-    void LoadShader(const Sid& shader_file);
+    // Does nothing when the shader is already loaded.
+    void LoadShader(const char* shader_file);
     Shader* GetShader(const Sid& shader_file)
     {
         return *shaders.Find(shader_file);
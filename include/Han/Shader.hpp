@@ -2,7 +2,7 @@
 
 #include "Han/Allocator.hpp"
 #include "Han/Collections/String.hpp"
-#include "Han/Collections/RobinHashMap.hpp"
+#include "Han/Collections/FlatHashMap.hpp"
 #include "Han/Core.hpp"
 #include "Han/Sid.hpp"
 #include "Han/Math/Mat4.hpp"
@@ -12,7 +12,7 @@ struct Shader
 {
     String name;
     uint32_t program;
-    RobinHashMap<Sid, int> location_cache;
+    FlatHashMap<Sid, int> location_cache;
     mutable bool bound;
 
 public:
@@ -32,6 +32,10 @@ public:
     void Unbind() const;
 
     void AddUniform(const char* loc);
+    void RemoveUniform(Sid loc);
+    // Forgets every cached location. Should be called when the program is relinked (e.g. on hot
+    // reload), since the locations can change.
+    void ClearUniforms();
 
     bool IsValid() const { return program != 0; }
 
@@ -1,126 +1,184 @@
 #pragma once
 
 #include <cstdint>
+#include <mutex>
+#include "Core.hpp"
+#include "Hash.hpp"
 #include "Collections/String.hpp"
+#include "Collections/StringPool.hpp"
 #include "Collections/RobinHashMap.hpp"
 #include "Logger.hpp"
 
+// Sids made with SID() register their string in the Sid database, so that it can be found from the
+// hash later (e.g. to print it). Sids made from literals with _sid ("u_model"_sid) are compile time
+// constants and never touch the database.
 #ifndef SID
 #define SID(x) Sid((x), MakeStringHash((x)))
 #endif
 
+// When HAN_SID_DATABASE is 1 (debug builds by default, tools builds can define it), literal Sids also
+// keep a pointer to their string, so that every Sid can be printed. Shipping builds leave it at 0:
+// Sids are just their 64 bit hash, SID() does not register anything and GetStr returns null. Nothing
+// should depend on the string of a Sid outside of logs and tools.
+#ifndef HAN_SID_DATABASE
+#if HAN_PRODUCTION
+#define HAN_SID_DATABASE 0
+#else
+#define HAN_SID_DATABASE 1
+#endif
+#endif
+
+// Evaluated at compile time for literals, see HashString.
 static constexpr uint64_t
 MakeStringHash(const char* str)
 {
-    // TODO: replace this with a better hash function
-    const char* c_str = str;
-    uint64_t hash = 5381;
-    int c = 0;
-    while ((c = *c_str++))
-        hash = ((hash << 5) + hash) + c;
-    return hash;
+    return HashString(str, StringLength(str));
 }
 
+// Maps the hashes of the Sids made with SID() to their strings. Sids are made from every thread
+// (asset import and parsing run on workers), so the database can be used concurrently: the hashes
+// are split between shards that each have their own lock, and threads interning different strings
+// rarely wait on each other. The strings are copied once into the string pool of their shard and
+// never move, so the pointers returned by FindStr stay valid while other threads add strings.
 class SidDatabase
 {
 public:
     static constexpr int kDatabaseSize{ 2048 };
+    static constexpr int kShardBits = 4;
+    static constexpr size_t kNumShards = (size_t)1 << kShardBits;
+    static constexpr size_t kPageSize = KILOBYTES(4);
 
+#if HAN_SID_DATABASE
+    // The allocator is used from every thread that makes Sids, so it should be thread safe.
+    // Without HAN_SID_DATABASE nothing is registered, so there is no global database to create.
     static void Initialize(Allocator* allocator);
     static void Terminate();
+#endif
 
-    SidDatabase(Allocator* allocator)
-        : allocator(allocator)
-        , _strings(allocator, kDatabaseSize)
-    {}
+    SidDatabase(Allocator* allocator);
 
     ~SidDatabase()
     {
         assert(allocator == nullptr);
     }
 
-    void Destroy()
-    {
-        allocator = nullptr;
-    }
+    // Frees the strings.
+    void Destroy();
 
-    void AddHash(uint64_t hash, const char* str)
-    {
-        assert(allocator);
-        String* entry = _strings.Find(hash);
-        if (entry) {
-            if (*entry != str) {
-                // ignore, since the string already exists
-                LOG_ERROR("String %s has the same hash as already interned string %s", str, entry->data);
-                assert(false);
-            }
-        } else {
-            _strings.Add(hash, String(allocator, str));
-        }
-    }
+    // Number of strings, and bytes taken by them in the pools.
+    size_t GetLen() const;
+    size_t GetBytesUsed() const;
 
-    const char* FindStr(uint64_t hash) const
-    {
-        const String* str = _strings.Find(hash);
-        if (str) {
-            return str->data;
-        } else {
-            return nullptr;
-        }
-    }
+    void AddHash(uint64_t hash, const char* str);
+
+    // The hash is forgotten, but its string stays in the pool until the database is destroyed.
+    void RemoveHash(uint64_t hash);
+
+    const char* FindStr(uint64_t hash) const;
 
 public:
     Allocator* allocator;
 
 private:
-    RobinHashMap<uint64_t, String> _strings;
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        RobinHashMap<uint64_t, const char*> strings;
+        StringPool pool;
+    };
+
+    // The low bits of the hash are used by the maps of the shards, the high ones pick the shard.
+    Shard& GetShard(uint64_t hash) { return _shards[hash >> (64 - kShardBits)]; }
+    const Shard& GetShard(uint64_t hash) const { return _shards[hash >> (64 - kShardBits)]; }
+
+private:
+    Shard _shards[kNumShards];
 };
 
+#if HAN_SID_DATABASE
 extern SidDatabase* g_debug_sid_database;
+#endif
 
 class Sid
 {
 public:
-    Sid()
+    constexpr Sid()
         : _hash(0)
     {}
 
     Sid(const char* str, uint64_t hash)
         : _hash(hash)
     {
+#if HAN_SID_DATABASE
         assert(g_debug_sid_database);
         g_debug_sid_database->AddHash(hash, str);
-#ifdef HAN_DEBUG
-        _str = GetStr();
+#else
+        (void)str;
+#endif
+    }
+
+    // Makes a Sid from a string that lives as long as the program, without registering it.
+    // See operator""_sid.
+    static constexpr Sid FromLiteral(const char* str, size_t len)
+    {
+        Sid sid;
+        sid._hash = HashString(str, len);
+#if HAN_SID_DATABASE
+        sid._str = str;
 #endif
+        return sid;
     }
 
-    bool IsEmpty() const { return _hash == 0; }
+    constexpr bool IsEmpty() const { return _hash == 0; }
 
+    // Returns null when the string is not known, which is always the case in shipping builds.
     const char* GetStr() const
     {
+#if HAN_SID_DATABASE
+        if (_str) {
+            return _str;
+        }
         return g_debug_sid_database->FindStr(_hash);
+#else
+        return nullptr;
+#endif
+    }
+
+    // For logs: the string, or fallback when it is not known.
+    const char* GetStrOr(const char* fallback) const
+    {
+        const char* str = GetStr();
+        return str ? str : fallback;
     }
 
-    bool operator==(const Sid& other) const
+    constexpr bool operator==(const Sid& other) const
     {
         return other._hash == _hash;
     }
 
-    bool operator!=(const Sid& other) const
+    constexpr bool operator!=(const Sid& other) const
     {
         return !operator==(other);
     }
 
-    uint64_t GetHash() const { return _hash;  }
+    constexpr uint64_t GetHash() const { return _hash;  }
 
 private:
     uint64_t _hash;
-#ifdef HAN_DEBUG
-    const char* _str;
+#if HAN_SID_DATABASE
+    // Only set for literal Sids, the others find their string in the database.
+    const char* _str = nullptr;
 #endif
 };
 
+// "u_model"_sid is hashed at compile time. Use it for names whose string is never needed at runtime
+// (uniforms, material values...), and SID() for the names of resources that are loaded from files.
+constexpr Sid
+operator""_sid(const char* str, size_t len)
+{
+    return Sid::FromLiteral(str, len);
+}
+
 namespace std
 {
     template<> struct hash<Sid>
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Han/Allocator.hpp"
+#include "Han/Core.hpp"
+#include "Han/Logger.hpp"
+#include "Han/Memory.hpp"
+#include "Han/Utils.hpp"
+#include "Han/VirtualMemory.hpp"
+#include <atomic>
+#include <stdint.h>
+
+// Allocates memory by bumping a pointer, like the LinearAllocator, but memory can be given back
+// in LIFO order by rolling the top of the stack back to a marker.
+// It is meant to be used for scratch memory: take a marker (or create a Scope) before doing some
+// temporary work, and everything allocated after it is released at once afterwards.
+//
+// The stack either uses memory it is given, or reserves a range of address space and commits its
+// pages as the top of the stack grows, like the VirtualLinearAllocator.
+class StackAllocator : public Allocator
+{
+public:
+    // The top of the stack, as an offset from the start of the memory.
+    using Marker = size_t;
+
+    // Frees everything that was allocated from the stack during the lifetime of the scope.
+    class Scope
+    {
+    public:
+        explicit Scope(StackAllocator* allocator)
+            : _allocator(allocator)
+            , _marker(allocator->GetMarker())
+        {}
+
+        ~Scope() { _allocator->FreeToMarker(_marker); }
+
+        DISABLE_OBJECT_COPY_AND_MOVE(Scope);
+
+    private:
+        StackAllocator* _allocator;
+        Marker _marker;
+    };
+
+    // Pages are committed in chunks of this size, to avoid a system call for every new page.
+    static constexpr size_t kCommitGranularity = KILOBYTES(64);
+
+    StackAllocator()
+        : _mem(nullptr)
+        , _bytes_allocated(0)
+        , _last_allocation(kNoAllocation)
+        , _last_allocation_start(0)
+        , _bytes_committed(0)
+        , _size(0)
+        , _reserved(false)
+        , _name(nullptr)
+    {}
+
+    StackAllocator(const char* name, const Memory& mem)
+        : StackAllocator(name, mem.ptr, mem.size)
+    {}
+
+    StackAllocator(const char* name, void* mem, size_t size)
+        : _mem(mem)
+        , _bytes_allocated(0)
+        , _last_allocation(kNoAllocation)
+        , _last_allocation_start(0)
+        , _bytes_committed(size)
+        , _size(size)
+        , _reserved(false)
+        , _name(name)
+    {
+        assert(_mem && "should be instantiated with memory");
+        assert(_size > 0 && "allocator should have allocated bytes");
+        assert(_name && "allocator should have a name");
+    }
+
+    // Only reserves address space, so reserve_size can be much larger than what is expected to be used.
+    StackAllocator(const char* name, size_t reserve_size)
+        : _mem(nullptr)
+        , _bytes_allocated(0)
+        , _last_allocation(kNoAllocation)
+        , _last_allocation_start(0)
+        , _bytes_committed(0)
+        , _size(AlignForward(reserve_size, VirtualMemory::GetPageSize()))
+        , _reserved(true)
+        , _name(name)
+    {
+        assert(_size > 0 && "allocator should reserve some memory");
+        assert(_name && "allocator should have a name");
+        _mem = VirtualMemory::Reserve(_size);
+        assert(_mem && "address space should be reserved");
+    }
+
+    ~StackAllocator()
+    {
+        if (_reserved && _mem) {
+            VirtualMemory::Release(_mem, _size);
+        }
+    }
+
+    DISABLE_OBJECT_COPY_AND_MOVE(StackAllocator);
+
+    // The allocations made before the marker cannot be rolled back or resized anymore,
+    // since they would cross it.
+    Marker GetMarker()
+    {
+        _last_allocation = kNoAllocation;
+        return _bytes_allocated.load(std::memory_order_relaxed);
+    }
+
+    void FreeToMarker(Marker marker)
+    {
+        const size_t bytes_allocated = _bytes_allocated.load(std::memory_order_relaxed);
+        ASSERT(marker <= bytes_allocated, "Marker should be below the top of the stack");
+        ReleaseRange((uint8_t*)_mem + marker, (uint8_t*)_mem + bytes_allocated);
+        _bytes_allocated.store(marker, std::memory_order_relaxed);
+        _last_allocation = kNoAllocation;
+    }
+
+    size_t GetAllocatedBytes() const override { return _bytes_allocated.load(std::memory_order_relaxed); }
+
+    const char* GetName() const override { return _name; }
+
+    // For a stack that reserved its memory, it is the reserved size.
+    size_t GetSize() const override { return _size; }
+
+    bool IsReserved() const { return _reserved; }
+    size_t GetCommittedBytes() const { return _bytes_committed; }
+
+    AllocatorType GetType() const override { return AllocatorType::Stack; }
+
+    void Clear() { FreeToMarker(0); }
+
+protected:
+    void* DoAllocate(size_t size, size_t alignment) override
+    {
+        ASSERT(_mem, "Allocator should be initialized");
+        ASSERT(IsPowerOfTwo(alignment), "Alignment should be a power of two");
+
+        const size_t bytes_allocated = _bytes_allocated.load(std::memory_order_relaxed);
+        const uintptr_t current = (uintptr_t)_mem + bytes_allocated;
+        const size_t padding = AlignForward(current, alignment) - current;
+
+        if (padding + size > _size - bytes_allocated) {
+            LOG_WARN("Cannot allocate %s memory in %s allocator (size of %s)",
+                     Utils::GetPrettySize(size).GetData(),
+                     _name,
+                     Utils::GetPrettySize(_size).GetData());
+            return nullptr;
+        }
+
+        if (!CommitUpTo(bytes_allocated + padding + size)) {
+            return nullptr;
+        }
+
+        _last_allocation = bytes_allocated;
+        _last_allocation_start = bytes_allocated + padding;
+        _bytes_allocated.store(bytes_allocated + padding + size, std::memory_order_relaxed);
+
+        return (void*)(current + padding);
+    }
+
+    // Only the last allocation can be given back to the stack. Any other pointer is ignored,
+    // and its memory is reclaimed when the stack is freed to a previous marker.
+    void DoDeallocate(void* ptr) override
+    {
+        if (!ptr || _last_allocation == kNoAllocation) {
+            return;
+        }
+
+        if (ptr == (uint8_t*)_mem + _last_allocation_start) {
+            _bytes_allocated.store(_last_allocation, std::memory_order_relaxed);
+            _last_allocation = kNoAllocation;
+        }
+    }
+
+    // Only the last allocation can be resized, by moving the top of the stack. It is matched by
+    // its start rather than by its end, since a zero sized allocation ends where the block before
+    // it ends.
+    bool DoTryExtend(void* ptr, size_t old_size, size_t new_size) override
+    {
+        const size_t offset = _last_allocation_start;
+        if (_last_allocation == kNoAllocation
+            || ptr != (uint8_t*)_mem + offset
+            || offset + old_size != _bytes_allocated.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        if (new_size > _size - offset || !CommitUpTo(offset + new_size)) {
+            return false;
+        }
+
+        _bytes_allocated.store(offset + new_size, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    // Makes sure that the first num_bytes of the memory are committed. Memory that was given to
+    // the stack is committed as a whole.
+    bool CommitUpTo(size_t num_bytes)
+    {
+        if (num_bytes <= _bytes_committed) {
+            return true;
+        }
+
+        const size_t granularity = HAN_MAX(kCommitGranularity, VirtualMemory::GetPageSize());
+        const size_t new_bytes_committed = HAN_MIN(AlignForward(num_bytes, granularity), _size);
+        if (!VirtualMemory::Commit((uint8_t*)_mem + _bytes_committed, new_bytes_committed - _bytes_committed)) {
+            return false;
+        }
+        _bytes_committed = new_bytes_committed;
+        return true;
+    }
+
+private:
+    static constexpr size_t kNoAllocation = (size_t)-1;
+
+private:
+    void* _mem;
+    // Only the owning thread changes it, but thread scratch stacks are sampled by the memory
+    // profiler from the main thread.
+    std::atomic<size_t> _bytes_allocated;
+    // Offset of the top of the stack before the last allocation was made.
+    size_t _last_allocation;
+    // Offset of the memory returned by the last allocation, after the alignment padding.
+    size_t _last_allocation_start;
+    size_t _bytes_committed;
+    size_t _size;
+    // Whether the memory was reserved by the stack, rather than given to it.
+    bool _reserved;
+    const char* _name;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Han/Allocator.hpp"
+#include "Han/Collections/HandlePool.hpp"
 #include "Han/Collections/String.hpp"
 #include "Han/Collections/StringView.hpp"
 #include "Han/Core.hpp"
@@ -33,7 +34,15 @@ public:
         , loaded(false)
     {}
 
+    Texture(Texture&& other) = default;
+    Texture& operator=(Texture&& other) = default;
+
     void Destroy();
     
     DISABLE_OBJECT_COPY(Texture);
 };
+
+// Textures are owned by the resource manager and referenced through handles, which stop resolving
+// once the texture is unloaded.
+using TextureHandle = Handle<Texture>;
+using TexturePool = HandlePool<Texture>;
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Han/Allocator.hpp"
+#include "Han/Core.hpp"
+#include "Han/Memory.hpp"
+#include <stdint.h>
+
+// Two-Level Segregated Fit allocator, a general purpose allocator with O(1) allocations and
+// deallocations over a contiguous region of memory.
+//
+// Free blocks are kept in segregated lists. The first level splits the sizes in powers of two,
+// and the second level splits every power of two in kSecondLevelCount linear ranges.
+// Two levels of bitmaps tell which lists are not empty, so a suitable free block is found
+// with a couple of bit scans. Freed blocks are merged with their free physical neighbours.
+//
+// Based on "TLSF: a New Dynamic Memory Allocator for Real-Time Systems" by M. Masmano et al.
+class TlsfAllocator : public Allocator
+{
+public:
+    struct Stats
+    {
+        size_t free_bytes;
+        size_t num_free_blocks;
+        size_t num_used_blocks;
+        size_t largest_free_block;
+        // Between 0 and 1. It is 0 when all the free memory is in a single block.
+        float fragmentation;
+    };
+
+    TlsfAllocator();
+    TlsfAllocator(const char* name, const Memory& mem);
+    TlsfAllocator(const char* name, void* mem, size_t size);
+
+    DISABLE_OBJECT_COPY_AND_MOVE(TlsfAllocator);
+
+    size_t GetAllocatedBytes() const override { return _bytes_allocated; }
+
+    const char* GetName() const override { return _name; }
+
+    size_t GetSize() const override { return _size; }
+
+    AllocatorType GetType() const override { return AllocatorType::Tlsf; }
+
+    // Walks every block of the pool, so it should only be used for debugging.
+    Stats GetStats() const;
+
+public:
+    static constexpr size_t kBlockAlignment = 16;
+    static constexpr int kSecondLevelCountLog2 = 5;
+    static constexpr int kSecondLevelCount = 1 << kSecondLevelCountLog2;
+    // Blocks smaller than kSmallBlockSize all go to the first list of the first level,
+    // which is split linearly in steps of kBlockAlignment.
+    static constexpr int kFirstLevelShift = kSecondLevelCountLog2 + 4;
+    static constexpr size_t kSmallBlockSize = (size_t)1 << kFirstLevelShift;
+    static constexpr int kFirstLevelMax = 32;
+    static constexpr int kFirstLevelCount = kFirstLevelMax - kFirstLevelShift + 1;
+    static constexpr size_t kMaxBlockSize = (size_t)1 << kFirstLevelMax;
+
+protected:
+    void* DoAllocate(size_t size, size_t alignment) override;
+    void DoDeallocate(void* ptr) override;
+    bool DoTryExtend(void* ptr, size_t old_size, size_t new_size) override;
+
+private:
+    struct BlockHeader
+    {
+        // The block that comes right before this one in memory.
+        BlockHeader* prev_physical;
+        // The size of the payload. The lowest bit is set when the block is free.
+        size_t size_and_flags;
+        // Only valid when the block is free, they take the beginning of the payload.
+        BlockHeader* next_free;
+        BlockHeader* prev_free;
+
+        size_t GetSize() const { return size_and_flags & ~kFreeFlag; }
+        void SetSize(size_t size) { size_and_flags = size | (size_and_flags & kFreeFlag); }
+        bool IsFree() const { return (size_and_flags & kFreeFlag) != 0; }
+        void SetFree(bool is_free) { size_and_flags = is_free ? (size_and_flags | kFreeFlag) : (size_and_flags & ~kFreeFlag); }
+        bool IsLast() const { return GetSize() == 0; }
+
+        void* GetPayload() { return (uint8_t*)this + kBlockOverhead; }
+        BlockHeader* GetNextPhysical() { return (BlockHeader*)((uint8_t*)GetPayload() + GetSize()); }
+        static BlockHeader* FromPayload(void* ptr) { return (BlockHeader*)((uint8_t*)ptr - kBlockOverhead); }
+    };
+
+    static constexpr size_t kFreeFlag = 1;
+    // Only the physical link and the size are kept when the block is in use.
+    static constexpr size_t kBlockOverhead = offsetof(BlockHeader, next_free);
+    static constexpr size_t kMinBlockSize = sizeof(BlockHeader) - kBlockOverhead;
+
+    static void MappingInsert(size_t size, int* fl, int* sl);
+    static void MappingSearch(size_t size, int* fl, int* sl);
+
+    BlockHeader* FindSuitableBlock(int* fl, int* sl);
+    void InsertFreeBlock(BlockHeader* block);
+    void RemoveFreeBlock(BlockHeader* block);
+    void RemoveFreeBlock(BlockHeader* block, int fl, int sl);
+
+    BlockHeader* Split(BlockHeader* block, size_t size);
+    BlockHeader* MergeWithPrevious(BlockHeader* block);
+    BlockHeader* MergeWithNext(BlockHeader* block);
+
+private:
+    void* _mem;
+    size_t _size;
+    size_t _bytes_allocated;
+    const char* _name;
+
+    BlockHeader* _first_block;
+    uint32_t _first_level_bitmap;
+    uint32_t _second_level_bitmaps[kFirstLevelCount];
+    BlockHeader* _free_lists[kFirstLevelCount][kSecondLevelCount];
+};
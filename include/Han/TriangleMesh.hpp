@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Han/Collections/Array.hpp"
+#include "Han/Collections/SmallArray.hpp"
 #include "Han/Collections/String.hpp"
 #include "Han/Math/Vec2.hpp"
 #include "Han/Math/Vec3.hpp"
@@ -22,7 +23,8 @@ struct SubMesh
     Quaternion local_orientation;
     
     VertexArray* vao;
-    Material* material;
+    // Resolved in the materials of the resource manager when the mesh is rendered.
+    MaterialHandle material;
 };
 
 struct TriangleMesh
@@ -38,7 +40,7 @@ struct TriangleMesh
     Array<Vec3> normals;
     Array<uint32_t> indices;
 
-    Array<SubMesh> sub_meshes;
+    SmallArray<SubMesh, 8> sub_meshes;
 
     TriangleMesh()
 		: TriangleMesh(nullptr)
@@ -75,6 +77,7 @@ struct TriangleMesh
             }
         }
         allocator = other.allocator;
+        name = other.name;
         vertices = std::move(other.vertices);
         uvs = std::move(other.uvs);
         colors = std::move(other.colors);
@@ -88,3 +91,5 @@ struct TriangleMesh
     TriangleMesh& operator=(const TriangleMesh& other) = delete;
 };
 
+using MeshHandle = Handle<TriangleMesh>;
+using MeshPool = HandlePool<TriangleMesh>;
@@ -82,7 +82,7 @@ ParseInt64(const uint8_t* data, size_t size)
         n += (int64_t)(data[i] - FIRST_ASCII_NUMBER);
     }
     
-    return n;
+    return is_negative ? -n : n;
 }
 
 static inline double
@@ -112,7 +112,7 @@ ParseDouble(const uint8_t* data, size_t size)
 	int32_t exp = 0;
 
     for (int64_t i = start; i < (int64_t)size; ++i) {
-		if (data[i] == 'e') {
+		if (data[i] == 'e' || data[i] == 'E') {
 			// Parse exponential number
 			++i;
 			int consumed;
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Han/Allocator.hpp"
+#include "Han/Core.hpp"
+#include "Han/Logger.hpp"
+#include "Han/Utils.hpp"
+#include "Han/VirtualMemory.hpp"
+#include <stdint.h>
+
+// A linear allocator that reserves a large range of address space up front, and only commits
+// the pages as the allocated memory grows. The reserved size can be much larger than what is
+// expected to be used, since reserved pages do not take physical memory.
+class VirtualLinearAllocator : public Allocator
+{
+public:
+    // Pages are committed in chunks of this size, to avoid a system call for every new page.
+    static constexpr size_t kCommitGranularity = KILOBYTES(64);
+
+    VirtualLinearAllocator()
+        : _mem(nullptr)
+        , _bytes_allocated(0)
+        , _last_allocation_start(kNoAllocation)
+        , _bytes_committed(0)
+        , _size(0)
+        , _name(nullptr)
+    {}
+
+    VirtualLinearAllocator(const char* name, size_t reserve_size)
+        : _mem(nullptr)
+        , _bytes_allocated(0)
+        , _last_allocation_start(kNoAllocation)
+        , _bytes_committed(0)
+        , _size(AlignForward(reserve_size, VirtualMemory::GetPageSize()))
+        , _name(name)
+    {
+        assert(_size > 0 && "allocator should reserve some memory");
+        assert(_name && "allocator should have a name");
+        _mem = VirtualMemory::Reserve(_size);
+        assert(_mem && "address space should be reserved");
+    }
+
+    ~VirtualLinearAllocator()
+    {
+        if (_mem) {
+            VirtualMemory::Release(_mem, _size);
+        }
+    }
+
+    DISABLE_OBJECT_COPY_AND_MOVE(VirtualLinearAllocator);
+
+    size_t GetAllocatedBytes() const override { return _bytes_allocated; }
+
+    const char* GetName() const override { return _name; }
+
+    // The reserved size, which is the maximum amount of memory that can be allocated.
+    size_t GetSize() const override { return _size; }
+
+    size_t GetCommittedBytes() const { return _bytes_committed; }
+
+    AllocatorType GetType() const override { return AllocatorType::VirtualLinear; }
+
+    // The committed pages are kept, so that they can be reused without system calls.
+    void Clear()
+    {
+        ReleaseRange(_mem, (uint8_t*)_mem + _bytes_allocated);
+        _bytes_allocated = 0;
+        _last_allocation_start = kNoAllocation;
+    }
+
+    // Gives the physical memory of the pages that are not in use back to the OS.
+    void Trim()
+    {
+        const size_t keep = AlignForward(_bytes_allocated, VirtualMemory::GetPageSize());
+        if (keep < _bytes_committed) {
+            VirtualMemory::Decommit((uint8_t*)_mem + keep, _bytes_committed - keep);
+            _bytes_committed = keep;
+        }
+    }
+
+protected:
+    void* DoAllocate(size_t size, size_t alignment) override
+    {
+        ASSERT(_mem, "Allocator should be initialized");
+        ASSERT(IsPowerOfTwo(alignment), "Alignment should be a power of two");
+
+        const uintptr_t current = (uintptr_t)_mem + _bytes_allocated;
+        const size_t padding = AlignForward(current, alignment) - current;
+
+        if (padding + size > _size - _bytes_allocated) {
+            LOG_WARN("Cannot allocate %s memory in %s allocator (reserved %s)",
+                     Utils::GetPrettySize(size).GetData(),
+                     _name,
+                     Utils::GetPrettySize(_size).GetData());
+            return nullptr;
+        }
+
+        const size_t new_bytes_allocated = _bytes_allocated + padding + size;
+        if (!CommitUpTo(new_bytes_allocated)) {
+            return nullptr;
+        }
+
+        _last_allocation_start = _bytes_allocated + padding;
+        _bytes_allocated = new_bytes_allocated;
+
+        return (void*)(current + padding);
+    }
+
+    void DoDeallocate(void* ptr) override
+    { /* Do nothing */
+        (void)ptr;
+    }
+
+    // Only the last allocation can be resized, by moving the top of the arena. It is matched by
+    // its start rather than by its end, since a zero sized allocation ends where the block before
+    // it ends.
+    bool DoTryExtend(void* ptr, size_t old_size, size_t new_size) override
+    {
+        const size_t offset = _last_allocation_start;
+        if (offset == kNoAllocation
+            || ptr != (uint8_t*)_mem + offset
+            || offset + old_size != _bytes_allocated) {
+            return false;
+        }
+
+        if (new_size > _size - offset || !CommitUpTo(offset + new_size)) {
+            return false;
+        }
+
+        _bytes_allocated = offset + new_size;
+        return true;
+    }
+
+private:
+    // Makes sure that the first num_bytes of the reserved range are committed.
+    bool CommitUpTo(size_t num_bytes)
+    {
+        if (num_bytes <= _bytes_committed) {
+            return true;
+        }
+
+        const size_t granularity = HAN_MAX(kCommitGranularity, VirtualMemory::GetPageSize());
+        const size_t new_bytes_committed = HAN_MIN(AlignForward(num_bytes, granularity), _size);
+        if (!VirtualMemory::Commit((uint8_t*)_mem + _bytes_committed, new_bytes_committed - _bytes_committed)) {
+            return false;
+        }
+        _bytes_committed = new_bytes_committed;
+        return true;
+    }
+
+private:
+    static constexpr size_t kNoAllocation = (size_t)-1;
+
+private:
+    void* _mem;
+    size_t _bytes_allocated;
+    // Offset of the memory returned by the last allocation, after the alignment padding.
+    size_t _last_allocation_start;
+    size_t _bytes_committed;
+    size_t _size;
+    const char* _name;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+// Thin wrappers around the virtual memory functions of the OS.
+// Reserved memory only takes address space. It has to be committed before it can be used.
+namespace VirtualMemory {
+
+size_t GetPageSize();
+
+// Reserves size bytes of address space. Returns nullptr on failure.
+void* Reserve(size_t size);
+
+// Makes the pages in [ptr, ptr + size) readable and writable. ptr should be page aligned.
+bool Commit(void* ptr, size_t size);
+
+// Gives the physical memory of the pages in [ptr, ptr + size) back to the OS,
+// while keeping the address space reserved.
+void Decommit(void* ptr, size_t size);
+
+// Releases a whole reservation made with Reserve.
+void Release(void* ptr, size_t size);
+
+} // namespace VirtualMemory
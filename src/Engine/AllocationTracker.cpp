@@ -0,0 +1,266 @@
+#include "Han/AllocationTracker.hpp"
+#include "Han/AllocatorFactory.hpp"
+#include "Han/Logger.hpp"
+#include "Han/Utils.hpp"
+#include <algorithm>
+#include <stdlib.h>
+
+static size_t
+HashPointer(void* ptr)
+{
+    // Allocations are at least 8 bytes aligned, so the lowest bits carry no information.
+    return (size_t)((((uint64_t)(uintptr_t)ptr >> 3) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+void
+Allocator::TrackAllocation(AllocationTracker* tracker, void* ptr, size_t size, const AllocationSite& site)
+{
+    tracker->OnAllocate(ptr, size, site);
+}
+
+void
+Allocator::TrackDeallocation(AllocationTracker* tracker, void* ptr)
+{
+    tracker->OnDeallocate(ptr);
+}
+
+void
+Allocator::TrackResize(AllocationTracker* tracker, void* ptr, size_t new_size)
+{
+    tracker->OnResize(ptr, new_size);
+}
+
+void
+Allocator::TrackRelease(AllocationTracker* tracker, void* begin, void* end)
+{
+    tracker->OnRelease(begin, end);
+}
+
+AllocationTracker::AllocationTracker()
+    : _records((Record*)calloc(kInitialCapacity, sizeof(Record)))
+    , _cap(kInitialCapacity)
+    , _len(0)
+    , _live_bytes(0)
+{
+    ASSERT(_records, "Not enough memory");
+}
+
+AllocationTracker::~AllocationTracker()
+{
+    free(_records);
+}
+
+void
+AllocationTracker::OnAllocate(void* ptr, size_t size, const AllocationSite& site)
+{
+    Record record;
+    record.ptr = ptr;
+    record.size = size;
+    record.site = site;
+    record.frame = AllocatorFactory::Instance().GetFrameNumber();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (2 * (_len + 1) > _cap) {
+        Grow();
+    }
+    InsertRecord(record);
+}
+
+void
+AllocationTracker::OnDeallocate(void* ptr)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t slot = GetSlot(ptr);
+    if (_records[slot].ptr) {
+        RemoveSlot(slot);
+    }
+}
+
+void
+AllocationTracker::OnResize(void* ptr, size_t new_size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Record& record = _records[GetSlot(ptr)];
+    if (record.ptr) {
+        _live_bytes = _live_bytes - record.size + new_size;
+        record.size = new_size;
+    }
+}
+
+void
+AllocationTracker::OnRelease(void* begin, void* end)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < _cap && _len > 0;) {
+        void* ptr = _records[i].ptr;
+        if (ptr && ptr >= begin && ptr < end) {
+            // Removing shifts the next records back, so the same slot has to be checked again.
+            RemoveSlot(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+size_t
+AllocationTracker::GetNumLiveAllocations() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _len;
+}
+
+size_t
+AllocationTracker::GetLiveBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _live_bytes;
+}
+
+void
+AllocationTracker::GetTopSites(Array<SiteStats>* out_sites, size_t max_sites) const
+{
+    out_sites->Clear();
+
+    // The records are copied with malloc, since the output array could use a tracked allocator.
+    size_t num_sites = 0;
+    SiteStats* sites = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        sites = (SiteStats*)malloc(HAN_MAX(_len, (size_t)1) * sizeof(SiteStats));
+        ASSERT(sites, "Not enough memory");
+        for (size_t i = 0; i < _cap; ++i) {
+            const Record& record = _records[i];
+            if (record.ptr) {
+                sites[num_sites++] = SiteStats{record.site, record.size, 1, record.frame};
+            }
+        }
+    }
+
+    // Group the records by call site.
+    std::sort(sites, sites + num_sites, [](const SiteStats& a, const SiteStats& b) {
+        return a.site.file != b.site.file ? a.site.file < b.site.file : a.site.line < b.site.line;
+    });
+
+    size_t num_merged = 0;
+    for (size_t i = 0; i < num_sites; ++i) {
+        SiteStats* last = num_merged > 0 ? &sites[num_merged - 1] : nullptr;
+        if (last && last->site.file == sites[i].site.file && last->site.line == sites[i].site.line) {
+            last->bytes += sites[i].bytes;
+            last->count += sites[i].count;
+            last->first_frame = HAN_MIN(last->first_frame, sites[i].first_frame);
+        } else {
+            sites[num_merged++] = sites[i];
+        }
+    }
+
+    std::sort(sites, sites + num_merged, [](const SiteStats& a, const SiteStats& b) {
+        return a.bytes > b.bytes;
+    });
+
+    for (size_t i = 0; i < HAN_MIN(num_merged, max_sites); ++i) {
+        out_sites->PushBack(sites[i]);
+    }
+
+    free(sites);
+}
+
+void
+AllocationTracker::ReportLeaks(const char* allocator_name) const
+{
+#if HAN_DEBUG
+    const size_t num_live_allocations = GetNumLiveAllocations();
+    if (num_live_allocations == 0) {
+        LOG_INFO("No leaks in allocator %s", allocator_name);
+        return;
+    }
+
+    LOG_WARN("%zu allocations (%s) are still alive in allocator %s",
+             num_live_allocations,
+             Utils::GetPrettySize(GetLiveBytes()).GetData(),
+             allocator_name);
+
+    Array<SiteStats> sites;
+    GetTopSites(&sites, 32);
+    for (const auto& site : sites) {
+        LOG_WARN("    %s:%d: %s in %zu allocations, the first one made in frame %llu",
+                 site.site.file ? site.site.file : "unknown",
+                 site.site.line,
+                 Utils::GetPrettySize(site.bytes).GetData(),
+                 site.count,
+                 (unsigned long long)site.first_frame);
+    }
+#else
+    // Nothing would be printed, the LOG_* macros are compiled out.
+    (void)allocator_name;
+#endif
+}
+
+size_t
+AllocationTracker::GetSlot(void* ptr) const
+{
+    const size_t mask = _cap - 1;
+    size_t slot = HashPointer(ptr) & mask;
+    while (_records[slot].ptr && _records[slot].ptr != ptr) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void
+AllocationTracker::InsertRecord(const Record& record)
+{
+    size_t slot = GetSlot(record.ptr);
+    if (_records[slot].ptr) {
+        // The same memory was given twice without being deallocated, e.g. after a Clear of an
+        // untracked range. Keep the newest record.
+        _live_bytes -= _records[slot].size;
+        --_len;
+    }
+    _records[slot] = record;
+    _live_bytes += record.size;
+    ++_len;
+}
+
+void
+AllocationTracker::RemoveSlot(size_t slot)
+{
+    const size_t mask = _cap - 1;
+    _live_bytes -= _records[slot].size;
+    --_len;
+    _records[slot].ptr = nullptr;
+
+    // Backward shift deletion: move back the records that would not be reachable anymore
+    // from their home slot, so that no tombstones are needed.
+    size_t hole = slot;
+    size_t next = (slot + 1) & mask;
+    while (_records[next].ptr) {
+        const size_t home = HashPointer(_records[next].ptr) & mask;
+        // Distance from the home slot to the hole and to the current slot, wrapping around.
+        if (((hole - home) & mask) < ((next - home) & mask)) {
+            _records[hole] = _records[next];
+            _records[next].ptr = nullptr;
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+}
+
+void
+AllocationTracker::Grow()
+{
+    Record* old_records = _records;
+    const size_t old_cap = _cap;
+
+    _cap *= 2;
+    _records = (Record*)calloc(_cap, sizeof(Record));
+    ASSERT(_records, "Not enough memory");
+    _len = 0;
+    _live_bytes = 0;
+
+    for (size_t i = 0; i < old_cap; ++i) {
+        if (old_records[i].ptr) {
+            InsertRecord(old_records[i]);
+        }
+    }
+    free(old_records);
+}
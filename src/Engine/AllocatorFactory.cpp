@@ -1,15 +1,41 @@
 #include "Han/AllocatorFactory.hpp"
 #include "Han/Core.hpp"
 #include "Han/Allocator.hpp"
+#include "Han/AllocationTracker.hpp"
+#include "Han/MallocAllocator.hpp"
+#include "Han/StackAllocator.hpp"
 #include "Han/Utils.hpp"
 #include <algorithm>
 #include <functional>
 
+// Trackers are allocated from their own allocator, so that they are not tracked themselves.
+// Like MallocAllocator::Instance(), it is never destroyed, since it is used by the destructor of the factory.
+static Allocator*
+GetTrackerAllocator()
+{
+	alignas(MallocAllocator) static uint8_t storage[sizeof(MallocAllocator)];
+	static MallocAllocator* tracker_allocator = ::new (storage) MallocAllocator("allocation_trackers");
+	return tracker_allocator;
+}
+
 AllocatorFactory::~AllocatorFactory()
 {
 	for (auto& node : _nodes) {
 		if (node.owns) {
 			_allocator->Delete(node.allocator);
+			_allocator->Deallocate(node.owned_memory);
+		}
+	}
+
+	// The trackers are deleted last, since deleting the allocators above deallocates memory
+	// from the tracked root allocator.
+	for (auto& node : _nodes) {
+		if (node.tracker) {
+			if (!node.owns) {
+				// The root allocator outlives the factory.
+				node.allocator->SetTracker(nullptr);
+			}
+			GetTrackerAllocator()->Delete(node.tracker);
 		}
 	}
 }
@@ -22,17 +48,122 @@ AllocatorFactory::Initialize(Allocator* allocator)
 }
 
 void
-AllocatorFactory::AddAllocator(Allocator* parent_allocator, Allocator* child_allocator)
+AllocatorFactory::NextFrame()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto& node : _nodes) {
+		node.history.Sample(node.allocator);
+	}
+	_frame_number.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+AllocatorFactory::EnableTracking()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_tracking_enabled = true;
+	for (auto& node : _nodes) {
+		TrackNode(&node);
+	}
+}
+
+void
+AllocatorFactory::ReportLeaks() const
+{
+	for (const auto& node : _nodes) {
+		// Linear allocators only free everything at once, so whatever is left in them (e.g. the
+		// memory of the arenas carved out of them) is not a leak.
+		const AllocatorType type = node.allocator->GetType();
+		if (type == AllocatorType::Linear || type == AllocatorType::VirtualLinear) {
+			continue;
+		}
+		if (node.tracker) {
+			node.tracker->ReportLeaks(node.allocator->GetName());
+		}
+	}
+}
+
+void
+AllocatorFactory::TrackNode(Node* node)
+{
+	if (!node->tracker) {
+		node->tracker = GetTrackerAllocator()->New<AllocationTracker>();
+		node->allocator->SetTracker(node->tracker);
+	}
+}
+
+struct AllocatorFactory::ThreadScratch
+{
+	StackAllocator* allocator = nullptr;
+
+	~ThreadScratch()
+	{
+		if (allocator) {
+			AllocatorFactory::Instance().ReleaseThreadScratchAllocator(allocator);
+		}
+	}
+};
+
+StackAllocator*
+AllocatorFactory::GetThreadScratchAllocator()
+{
+	static thread_local ThreadScratch thread_scratch;
+	if (thread_scratch.allocator) {
+		return thread_scratch.allocator;
+	}
+
+	int index;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		const size_t num_free = _free_thread_scratch_allocators.GetLen();
+		if (num_free > 0) {
+			thread_scratch.allocator = _free_thread_scratch_allocators[num_free - 1];
+			_free_thread_scratch_allocators.PopBack();
+			return thread_scratch.allocator;
+		}
+		index = _num_thread_scratch_allocators++;
+	}
+
+	// The name is stored right before the memory of the stack, so that both are released together.
+	// It has to be unique, since parents are found by name.
+	const size_t name_size = 32;
+	uint8_t* memory = (uint8_t*)_allocator->Allocate(name_size + kThreadScratchSize);
+	char* name = (char*)memory;
+	snprintf(name, name_size, "thread_scratch_%d", index);
+
+	thread_scratch.allocator = _allocator->New<StackAllocator>(name, memory + name_size, kThreadScratchSize);
+	AddAllocator(nullptr, thread_scratch.allocator, memory);
+	return thread_scratch.allocator;
+}
+
+void
+AllocatorFactory::ReleaseThreadScratchAllocator(StackAllocator* allocator)
 {
+	// Whatever the thread left on its stack is garbage now.
+	allocator->Clear();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_free_thread_scratch_allocators.PushBack(allocator);
+}
+
+void
+AllocatorFactory::AddAllocator(Allocator* parent_allocator, Allocator* child_allocator, void* owned_memory)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
 	auto node_type = parent_allocator == nullptr ? NodeType::Root : NodeType::Child;
 	_nodes.PushBack(Node(node_type, child_allocator, true));
 	size_t added_index = _nodes.GetLen() - 1;
+	_nodes[added_index].owned_memory = owned_memory;
+	if (_tracking_enabled) {
+		TrackNode(&_nodes[added_index]);
+	}
 
 	if (parent_allocator) {
 		LOG_DEBUG(
 			"Adding allocator %s (%s) child of %s",
 			child_allocator->GetName(),
-			Utils::GetPrettySize(child_allocator->GetSize()).data, parent_allocator->GetName());
+			Utils::GetPrettySize(child_allocator->GetSize()).GetData(), parent_allocator->GetName());
 		auto parent_it = std::find_if(_nodes.begin(), _nodes.end(), [parent_allocator](const Node& node) -> bool {
 			return node.allocator->GetName() == parent_allocator->GetName();
 		});
@@ -42,7 +173,7 @@ AllocatorFactory::AddAllocator(Allocator* parent_allocator, Allocator* child_all
 		LOG_DEBUG(
 			"Adding root allocator %s of size %s",
 			child_allocator->GetName(),
-			Utils::GetPrettySize(child_allocator->GetSize()).data);
+			Utils::GetPrettySize(child_allocator->GetSize()).GetData());
 	}
 }
 
@@ -51,3 +182,20 @@ AllocatorFactory::Node::AddChild(size_t index)
 {
 	children_indices.PushBack(index);
 }
+
+void
+AllocatorFactory::History::Sample(const Allocator* allocator)
+{
+	const size_t bytes = allocator->GetAllocatedBytes();
+	const size_t num_allocations = allocator->GetNumAllocations();
+	const size_t num_deallocations = allocator->GetNumDeallocations();
+
+	bytes_in_use[offset] = (float)bytes;
+	allocations[offset] = (float)(num_allocations - last_num_allocations);
+	deallocations[offset] = (float)(num_deallocations - last_num_deallocations);
+	offset = (offset + 1) % kLength;
+
+	peak_bytes = HAN_MAX(peak_bytes, bytes);
+	last_num_allocations = num_allocations;
+	last_num_deallocations = num_deallocations;
+}
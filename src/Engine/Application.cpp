@@ -19,8 +19,11 @@ Application* Application::Instance()
 Application::Application(ApplicationParams params)
 	: _params(params)
 	, _window(nullptr)
+	, _resource_scratch_allocator(nullptr)
 	, _resource_manager(nullptr)
 	, _running(false)
+	, _frame_allocators{nullptr, nullptr}
+	, _frame_index(0)
 {
 	ASSERT(params.memory_size, "Should have memory size specified");
 	ASSERT(params.screen_width, "Should have screen width specified");
@@ -34,15 +37,36 @@ Application::Initialize()
 {
 	LOG_INFO("Initializing the engine");
 	AllocatorFactory::Instance().Initialize(MallocAllocator::Instance());
+	if (_params.track_allocations) {
+		AllocatorFactory::Instance().EnableTracking();
+	}
 
-    const size_t resource_manager_designated_memory = MEGABYTES(64);
+    // Only address space is reserved for the resource scratch stack, so it can be generous.
+    const size_t resource_scratch_reserved_memory = GIGABYTES(4ull);
+    const size_t frame_designated_memory = MEGABYTES(4);
+    const size_t layers_designated_memory = MEGABYTES(4);
 
-    _memory = Memory(_params.memory_size);
-    _main_allocator = AllocatorFactory::Instance().Create<LinearAllocator>("main", _memory);
+    _main_allocator = AllocatorFactory::Instance().Create<VirtualLinearAllocator>("main", _params.memory_size);
     _temp_allocator = AllocatorFactory::Instance().Create<MallocAllocator>("temporary_allocator");
 
-	// TODO: consider using another allocator here.
-	_layer_stack.SetAllocator(_temp_allocator);
+    const char* frame_allocator_names[2] = { "frame_0", "frame_1" };
+    for (int i = 0; i < 2; ++i) {
+        _frame_allocators[i] = AllocatorFactory::Instance().CreateFromParent<LinearAllocator>(
+            _main_allocator,
+            frame_allocator_names[i],
+            _main_allocator->Allocate(frame_designated_memory),
+            frame_designated_memory
+        );
+    }
+
+	// Layers live for a long time and can be popped in any order.
+	Allocator* layers_allocator = AllocatorFactory::Instance().CreateFromParent<TlsfAllocator>(
+		_main_allocator,
+		"layers",
+		_main_allocator->Allocate(layers_designated_memory),
+		layers_designated_memory
+	);
+	_layer_stack.SetAllocator(layers_allocator);
 
     // ===============================================================
     // First, load the engine configuration file
@@ -87,16 +111,21 @@ Application::Initialize()
 
     _running = true;
 
-    _resource_manager_allocator = AllocatorFactory::Instance().CreateFromParent<LinearAllocator>(
-		_main_allocator,
-        "resource_manager",
-        _main_allocator->Allocate(resource_manager_designated_memory),
-        resource_manager_designated_memory
+    // Resources can be unloaded in any order, and their memory goes back to the OS. Malloc also
+    // leaves the amount of resources unbounded.
+    _resource_manager_allocator = AllocatorFactory::Instance().Create<MallocAllocator>("resource_manager");
+    // Whole model and texture files are loaded into it, so it grows as much as they need.
+    _resource_scratch_allocator = AllocatorFactory::Instance().Create<StackAllocator>(
+        "resource_scratch",
+        resource_scratch_reserved_memory
     );
-    _resource_manager = _main_allocator->New<ResourceManager>(_resource_manager_allocator, _temp_allocator);
+    _resource_manager = _main_allocator->New<ResourceManager>(_resource_manager_allocator, _resource_scratch_allocator);
     _resource_manager->Create();
 
-    SidDatabase::Initialize(_main_allocator);
+#if HAN_SID_DATABASE
+    // Sids are made from worker threads as well, so the database gets its own thread safe allocator.
+    SidDatabase::Initialize(AllocatorFactory::Instance().Create<MallocAllocator>("sid_database"));
+#endif
 
 	_start_time = std::chrono::high_resolution_clock::now();
 
@@ -111,13 +140,19 @@ Application::Shutdown()
 	_layer_stack.Clear();
 
 	LOG_INFO("Destroying the engine");
+#if HAN_SID_DATABASE
     SidDatabase::Terminate();
+#endif
     _resource_manager->Destroy();
     _main_allocator->Delete(_resource_manager);
     Graphics::LowLevelApi::Terminate();
     _main_allocator->Delete(_window);
 
 	Editor::Terminate();
+
+	if (AllocatorFactory::Instance().IsTrackingEnabled()) {
+		AllocatorFactory::Instance().ReportLeaks();
+	}
 }
 
 void
@@ -130,6 +165,9 @@ Application::Run()
 	const double desired_fps = 60.0f;
 
     while (_running) {
+		AllocatorFactory::Instance().NextFrame();
+		SwapFrameAllocators();
+
 		auto now = GetTime();
 
 		DeltaTime delta;
@@ -151,6 +189,14 @@ Application::Run()
 	Shutdown();
 }
 
+void
+Application::SwapFrameAllocators()
+{
+	// The allocator that was used two frames ago is reused, the one of the previous frame is kept alive.
+	_frame_index ^= 1;
+	_frame_allocators[_frame_index]->Clear();
+}
+
 void
 Application::PushLayer(Layer* layer)
 {
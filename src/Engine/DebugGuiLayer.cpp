@@ -2,9 +2,14 @@
 #include "Han/Logger.hpp"
 #include "Han/Application.hpp"
 #include "Han/AllocatorFactory.hpp"
+#include "Han/AllocationTracker.hpp"
+#include "Han/StackAllocator.hpp"
+#include "Han/TlsfAllocator.hpp"
+#include "Han/VirtualLinearAllocator.hpp"
 
 #include "imgui/imgui.h"
 #include "imgui/examples/imgui_impl_opengl3.h"
+#include <stdio.h>
 
 static bool IsKeyRelevant(KeyCode kc)
 {
@@ -65,6 +70,48 @@ DebugGuiLayer::OnDetach()
 	ImGui::DestroyContext();
 }
 
+static void
+ShowAllocationSites(const AllocationTracker* tracker)
+{
+	if (!ImGui::TreeNode("Top allocation sites", "Top allocation sites (%zu live allocations)", tracker->GetNumLiveAllocations())) {
+		return;
+	}
+
+	Array<AllocationTracker::SiteStats> sites(Application::Instance()->GetFrameAllocator());
+	tracker->GetTopSites(&sites, 10);
+	for (const auto& site : sites) {
+		auto pretty_bytes = Utils::GetPrettySize(site.bytes, Application::Instance()->GetFrameAllocator());
+		ImGui::Text("%s in %zu allocations at %s:%d (since frame %llu)",
+			pretty_bytes.GetData(),
+			site.count,
+			site.site.file ? site.site.file : "unknown",
+			site.site.line,
+			(unsigned long long)site.first_frame);
+	}
+	ImGui::TreePop();
+}
+
+static void
+ShowAllocatorHistory(const AllocatorFactory::History& history, size_t scale_max_bytes)
+{
+	using History = AllocatorFactory::History;
+
+	// The latest sample is right before the write offset.
+	const int last = (history.offset + History::kLength - 1) % History::kLength;
+	auto pretty_current_size = Utils::GetPrettySize((size_t)history.bytes_in_use[last], Application::Instance()->GetFrameAllocator());
+	auto pretty_peak_size = Utils::GetPrettySize(history.peak_bytes, Application::Instance()->GetFrameAllocator());
+
+	char overlay[128];
+	snprintf(overlay, sizeof(overlay), "%s (peak %s)", pretty_current_size.GetData(), pretty_peak_size.GetData());
+	ImGui::PlotLines("Bytes in use", history.bytes_in_use, History::kLength, history.offset, overlay, 0.0f, (float)scale_max_bytes, ImVec2(0, 60));
+
+	snprintf(overlay, sizeof(overlay), "%.0f this frame", history.allocations[last]);
+	ImGui::PlotHistogram("Allocations", history.allocations, History::kLength, history.offset, overlay, 0.0f, FLT_MAX, ImVec2(0, 40));
+
+	snprintf(overlay, sizeof(overlay), "%.0f this frame", history.deallocations[last]);
+	ImGui::PlotHistogram("Frees", history.deallocations, History::kLength, history.offset, overlay, 0.0f, FLT_MAX, ImVec2(0, 40));
+}
+
 static void
 ShowAllocator(const AllocatorFactory::Node& node, const Array<AllocatorFactory::Node>& nodes, int* tree_node_id)
 {
@@ -77,16 +124,50 @@ ShowAllocator(const AllocatorFactory::Node& node, const Array<AllocatorFactory::
 	void* id = (void*)*tree_node_id;
 	*tree_node_id += 1;
 
-	int flags = node.children_indices.GetLen() == 0 ? ImGuiTreeNodeFlags_Leaf : ImGuiTreeNodeFlags_None;
+	// Every node has at least its history to show.
+	int flags = ImGuiTreeNodeFlags_None;
 
 	switch (node.allocator->GetType()) {
-		case AllocatorType::Linear: open = ImGui::TreeNodeEx(id, flags, "[LinearAllocator] %s: %s of %s", name, pretty_used_size.data, pretty_total_size.data); break;
-		case AllocatorType::Malloc: open = ImGui::TreeNodeEx(id, flags, "[MallocAllocator] %s: Used = %s", name, pretty_used_size.data); break;
+		case AllocatorType::Linear: open = ImGui::TreeNodeEx(id, flags, "[LinearAllocator] %s: %s of %s", name, pretty_used_size.GetData(), pretty_total_size.GetData()); break;
+		case AllocatorType::Malloc: open = ImGui::TreeNodeEx(id, flags, "[MallocAllocator] %s: Used = %s", name, pretty_used_size.GetData()); break;
+		case AllocatorType::Stack: {
+			auto* stack = static_cast<StackAllocator*>(node.allocator);
+			if (stack->IsReserved()) {
+				auto pretty_committed_size = Utils::GetPrettySize(stack->GetCommittedBytes());
+				open = ImGui::TreeNodeEx(id, flags, "[StackAllocator] %s: %s of %s (committed %s)", name, pretty_used_size.GetData(), pretty_total_size.GetData(), pretty_committed_size.GetData());
+			} else {
+				open = ImGui::TreeNodeEx(id, flags, "[StackAllocator] %s: %s of %s", name, pretty_used_size.GetData(), pretty_total_size.GetData());
+			}
+			break;
+		}
+		case AllocatorType::VirtualLinear: {
+			auto pretty_committed_size = Utils::GetPrettySize(static_cast<VirtualLinearAllocator*>(node.allocator)->GetCommittedBytes());
+			open = ImGui::TreeNodeEx(id, flags, "[VirtualLinearAllocator] %s: %s of %s (committed %s)", name, pretty_used_size.GetData(), pretty_total_size.GetData(), pretty_committed_size.GetData());
+			break;
+		}
+		case AllocatorType::Tlsf: {
+			auto stats = static_cast<TlsfAllocator*>(node.allocator)->GetStats();
+			auto pretty_largest_free_size = Utils::GetPrettySize(stats.largest_free_block);
+			open = ImGui::TreeNodeEx(id, flags, "[TlsfAllocator] %s: %s of %s (%zu free blocks, largest %s, %.1f%% fragmentation)",
+				name, pretty_used_size.GetData(), pretty_total_size.GetData(),
+				stats.num_free_blocks, pretty_largest_free_size.GetData(), stats.fragmentation * 100.0f);
+			break;
+		}
 		default: UNREACHABLE; break;
 	}
 
 	// Iterate over each child
 	if (open) {
+		// Fixed size arenas are plotted against their size, to show how much headroom is left.
+		// Allocators without a real limit (malloc, reserved address space) are plotted against their peak.
+		const AllocatorType type = node.allocator->GetType();
+		const bool has_reserved_memory = type == AllocatorType::VirtualLinear
+			|| (type == AllocatorType::Stack && static_cast<const StackAllocator*>(node.allocator)->IsReserved());
+		const bool has_fixed_size = node.allocator->GetSize() > 0 && !has_reserved_memory;
+		ShowAllocatorHistory(node.history, has_fixed_size ? node.allocator->GetSize() : node.history.peak_bytes);
+		if (const AllocationTracker* tracker = node.allocator->GetTracker()) {
+			ShowAllocationSites(tracker);
+		}
 		for (const auto child_index : node.children_indices) {
 			ASSERT(child_index >= 0 && child_index < nodes.GetLen(), "Index should be valid based on the size of the nodes array");
 			const auto& child_node = nodes[child_index];
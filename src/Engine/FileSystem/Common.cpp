@@ -40,7 +40,10 @@ FileSystem::LoadFileToMemory(Allocator* allocator, const Path& path, size_t* out
     assert(file_size > 0);
 
     file_mem = (uint8_t*)allocator->Allocate(file_size);
-    assert(file_mem && "There should be enough memory on the allocator");
+    if (!file_mem) {
+        LOG_ERROR("Not enough memory to load %s", path.data);
+        goto cleanup_file;
+    }
 
     if (fread(file_mem, 1, file_size, fp) < file_size) {
         // Failed to read all of the file
@@ -2,6 +2,7 @@
 #include "Han/FileSystem.hpp"
 #include "Han/Logger.hpp"
 #include "Han/Json.hpp"
+#include "Han/Collections/SmallArray.hpp"
 #include "Han/ResourceManager.hpp"
 
 #define CHUNK_TYPE_JSON 0x4E4F534A
@@ -48,22 +49,41 @@ struct GltfImage
     String mime_type;
     String uri;
 
-    Texture* LoadInLinearSpace(ResourceManager* rm) const
+    TextureHandle LoadInLinearSpace(ResourceManager* rm) const
     {
-        return rm->LoadTexture(SID(uri.data), LoadTextureFlags_LinearSpace);
+        return rm->LoadTexture(uri.GetData(), LoadTextureFlags_LinearSpace);
     }
 
-    Texture* LoadAsAlbedo(ResourceManager* rm) const
+    TextureHandle LoadAsAlbedo(ResourceManager* rm) const
     {
-        return rm->LoadTexture(SID(uri.data));
+        return rm->LoadTexture(uri.GetData());
     }
 };
 
+struct GltfAttribute
+{
+    String name;
+    int32_t accessor;
+};
+
 struct GltfPrimitive
 {
-    RobinHashMap<String, int32_t> attributes;
+    // A primitive has a handful of attributes (POSITION, NORMAL...), a linear search over them
+    // is cheaper than a hash map.
+    SmallArray<GltfAttribute, 8> attributes;
     int32_t indices = -1;
     int32_t material = -1;
+
+    // Returns the accessor index of the attribute, or null if the primitive does not have it.
+    const int32_t* FindAttribute(StringView name) const
+    {
+        for (const auto& attribute : attributes) {
+            if (attribute.name == name) {
+                return &attribute.accessor;
+            }
+        }
+        return nullptr;
+    }
 };
 
 struct GltfMesh
@@ -108,10 +128,9 @@ struct GltfBuffer
         , byte_length(byte_length)
     {
         size_t file_size;
+        // The caller checks data, since a constructor cannot fail.
         data = FileSystem::LoadFileToMemory(alloc, path, &file_size);
-
-        ASSERT(data, "The buffer should exist");
-        ASSERT(file_size == byte_length, "sizes should be equal");
+        ASSERT(!data || file_size == byte_length, "sizes should be equal");
     }
 
     GltfBuffer(GltfBuffer&& buf)
@@ -267,7 +286,7 @@ static bool
 TryGetRotation(const Json::Val* rotation, Quaternion* out)
 {
     assert(out);
-    const Array<Json::Val>* rotation_array = rotation->AsArray();
+    const Json::ArrayView* rotation_array = rotation->AsArray();
     if (!rotation_array) {
         return false;
     }
@@ -299,7 +318,7 @@ static bool
 TryGetFloat(const Json::Val* vec, float* out)
 {
     assert(out);
-    const Array<Json::Val>* translation_array = vec->AsArray();
+    const Json::ArrayView* translation_array = vec->AsArray();
     if (!translation_array) { return false; }
     if (translation_array->len != 1) { return false; }
 
@@ -314,7 +333,7 @@ static bool
 TryGetScalar(const Json::Val* vec, int64_t* out)
 {
     assert(out);
-    const Array<Json::Val>* translation_array = vec->AsArray();
+    const Json::ArrayView* translation_array = vec->AsArray();
     if (!translation_array) { return false; }
     if (translation_array->len != 1) { return false; }
 
@@ -329,7 +348,7 @@ static bool
 TryGetVec2(const Json::Val* vec, Vec2* out)
 {
     assert(out);
-    const Array<Json::Val>* translation_array = vec->AsArray();
+    const Json::ArrayView* translation_array = vec->AsArray();
     if (!translation_array) { return false; }
     if (translation_array->len != 2) { return false; }
 
@@ -350,7 +369,7 @@ static bool
 TryGetVec3(const Json::Val* vec, Vec3* out)
 {
     assert(out);
-    const Array<Json::Val>* translation_array = vec->AsArray();
+    const Json::ArrayView* translation_array = vec->AsArray();
     if (!translation_array) {
         return false;
     }
@@ -379,7 +398,7 @@ static bool
 TryGetVec4(const Json::Val* vec, Vec4* out)
 {
     assert(out);
-    const Array<Json::Val>* translation_array = vec->AsArray();
+    const Json::ArrayView* translation_array = vec->AsArray();
     if (!translation_array) {
         return false;
     }
@@ -408,51 +427,52 @@ TryGetVec4(const Json::Val* vec, Vec4* out)
 }
 
 bool
-TryGetNodes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfNode>* out_nodes)
+TryGetNodes(Allocator* alloc, const Json::Object* gltf_file, Array<GltfNode>* out_nodes)
 {
     assert(alloc);
     assert(out_nodes);
     
-    const Json::Val* nodes_val = gltf_file->Find(String(alloc, "nodes"));
+    const Json::Val* nodes_val = gltf_file->Find("nodes");
     if (!nodes_val) {
         LOG_ERROR("Was expecting a nodes array");
         return false;
     }
     
-    const Array<Json::Val>* nodes = nodes_val->AsArray();
+    const Json::ArrayView* nodes = nodes_val->AsArray();
     if (!nodes) {
         LOG_ERROR("Was expecting a nodes array");
         return false;
     }
     
     *out_nodes = Array<GltfNode>(alloc);
+    out_nodes->Reserve(nodes->len);
     
     for (size_t i = 0; i < nodes->len; ++i) {
-        const RobinHashMap<String, Json::Val>* raw_node = (*nodes)[i].AsObject();
+        const Json::Object* raw_node = (*nodes)[i].AsObject();
         if (!raw_node) {
             LOG_ERROR("Was expecting a node object");
             return false;
         }
         
-        const Json::Val* name_val = raw_node->Find(String(alloc, "name"));
+        const Json::Val* name_val = raw_node->Find("name");
         if (name_val && !name_val->IsString()) {
             LOG_ERROR("Was expecting a name property as string");
             return false;
         }
         
-        const Json::Val* mesh_val = raw_node->Find(String(alloc, "mesh"));
+        const Json::Val* mesh_val = raw_node->Find("mesh");
         if (mesh_val && !mesh_val->IsInteger()) {
             LOG_ERROR("Was expecting a mesh property as int");
             return false;
         }
 
-        const Json::Val* rotation_val = raw_node->Find(String(alloc, "rotation"));
+        const Json::Val* rotation_val = raw_node->Find("rotation");
         if (rotation_val && !rotation_val->IsArray()) {
             LOG_ERROR("Was expecting a rotation property");
             return false;
         }
 
-        const Json::Val* translation_val = raw_node->Find(String(alloc, "translation"));
+        const Json::Val* translation_val = raw_node->Find("translation");
         if (translation_val && !translation_val->IsArray()) {
             LOG_ERROR("Was expecting a translation property");
             return false;
@@ -460,7 +480,7 @@ TryGetNodes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
         
         GltfNode out_node;
 		if (name_val) {
-			out_node.name = String(alloc, name_val->AsString()->View());
+			out_node.name = String(alloc, *name_val->AsString());
 		}
 		if (mesh_val) {
 			out_node.mesh = (int32_t)*mesh_val->AsInt64();
@@ -487,68 +507,70 @@ TryGetNodes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
 }
 
 bool
-TryGetMeshes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfMesh>* out_meshes)
+TryGetMeshes(Allocator* alloc, const Json::Object* gltf_file, Array<GltfMesh>* out_meshes)
 {
     assert(alloc);
     assert(out_meshes);
     
-    const Json::Val* meshes_val = gltf_file->Find(String(alloc, "meshes"));
+    const Json::Val* meshes_val = gltf_file->Find("meshes");
     if (!meshes_val) {
         LOG_ERROR("Was expecting a meshes array");
         return false;
     }
     
-    const Array<Json::Val>* meshes = meshes_val->AsArray();
+    const Json::ArrayView* meshes = meshes_val->AsArray();
     if (!meshes) {
         LOG_ERROR("Was expecting a meshes array");
         return false;
     }
     
     *out_meshes = Array<GltfMesh>(alloc);
+    out_meshes->Reserve(meshes->len);
     
     for (size_t i = 0; i < meshes->len; ++i) {
-        const RobinHashMap<String, Json::Val>* mesh = (*meshes)[i].AsObject();
+        const Json::Object* mesh = (*meshes)[i].AsObject();
         if (!mesh) {
             LOG_ERROR("Was expecting a mesh object");
             return false;
         }
         
-        const Json::Val* name_val = mesh->Find(String(alloc, "name"));
+        const Json::Val* name_val = mesh->Find("name");
         if (!name_val || !name_val->IsString()) {
             LOG_ERROR("Was expecting a name property");
             return false;
         }
         
-        const Json::Val* primitives_val = mesh->Find(String(alloc, "primitives"));
+        const Json::Val* primitives_val = mesh->Find("primitives");
         if (!primitives_val || !primitives_val->IsArray()) {
             LOG_ERROR("Was expecting a primitives array");
             return false;
         }
         
         GltfMesh out_mesh;
-        out_mesh.name = String(alloc, name_val->AsString()->View());
+        out_mesh.name = String(alloc, *name_val->AsString());
         out_mesh.primitives = Array<GltfPrimitive>(alloc);
+        out_mesh.primitives.Reserve(primitives_val->AsArray()->len);
         
         for (size_t pi = 0; pi < primitives_val->AsArray()->len; ++pi) {
-            const RobinHashMap<String, Json::Val>* raw_primitive = (*primitives_val->AsArray())[pi].AsObject();
+            const Json::Object* raw_primitive = (*primitives_val->AsArray())[pi].AsObject();
             if (!raw_primitive) {
                 LOG_ERROR("Was expecting a primitive object");
                 return false;
             }
 
-            const Json::Val* raw_indices = raw_primitive->Find(String(alloc, "indices"));
+            const Json::Val* raw_indices = raw_primitive->Find("indices");
             if (!raw_indices || !raw_indices->IsInteger()) {
                 LOG_ERROR("Was expecting a indice property");
                 return false;
             }
 
-            const Json::Val* raw_material = raw_primitive->Find(String(alloc, "material"));
+            const Json::Val* raw_material = raw_primitive->Find("material");
             if (!raw_material || !raw_material->IsInteger()) {
                 LOG_ERROR("Was expecting a material property");
                 return false;
             }
 
-            const Json::Val* raw_attributes = raw_primitive->Find(String(alloc, "attributes"));
+            const Json::Val* raw_attributes = raw_primitive->Find("attributes");
             if (!raw_attributes || !raw_attributes->IsObject()) {
                 LOG_ERROR("Was expecting an attributes property");
                 return false;
@@ -557,7 +579,7 @@ TryGetMeshes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
             GltfPrimitive primitive;
             primitive.indices = (int32_t)*raw_indices->AsInt64();
             primitive.material = (int32_t)*raw_material->AsInt64();
-            primitive.attributes = RobinHashMap<String, int>(alloc, 16);
+            primitive.attributes = SmallArray<GltfAttribute, 8>(alloc);
 
             for (const auto& pair : *raw_attributes->AsObject()) {
                 const int64_t* val = pair.val.AsInt64();
@@ -566,10 +588,10 @@ TryGetMeshes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
                     return false;
                 }
 
-                primitive.attributes.Add(
-                    String(alloc, pair.key.View()),
+                primitive.attributes.PushBack(GltfAttribute{
+                    String(alloc, pair.key),
                     (int32_t)*val
-                );
+                });
             }
 
             out_mesh.primitives.PushBack(std::move(primitive));
@@ -582,47 +604,52 @@ TryGetMeshes(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
 }
 
 bool
-TryGetBuffers(Allocator* alloc, const Path& directory, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfBuffer>* out_buffers)
+TryGetBuffers(Allocator* alloc, const Path& directory, const Json::Object* gltf_file, Array<GltfBuffer>* out_buffers)
 {
     assert(alloc);
     assert(out_buffers);
     assert(gltf_file);
     
-    const Json::Val* buffers_val = gltf_file->Find(String(alloc, "buffers"));
+    const Json::Val* buffers_val = gltf_file->Find("buffers");
     if (!buffers_val) {
         LOG_ERROR("Was expecting a buffers array");
         return false;
     }
     
-    const Array<Json::Val>* buffers = buffers_val->AsArray();
+    const Json::ArrayView* buffers = buffers_val->AsArray();
     if (!buffers) {
         LOG_ERROR("Was expecting a buffers array");
         return false;
     }
     
     *out_buffers = Array<GltfBuffer>(alloc);
+    out_buffers->Reserve(buffers->len);
     
     for (size_t i = 0; i < buffers->len; ++i) {
-        const RobinHashMap<String, Json::Val>* buffer = (*buffers)[i].AsObject();
+        const Json::Object* buffer = (*buffers)[i].AsObject();
         if (!buffer) {
             LOG_ERROR("Was expecting a buffer object");
             return false;
         }
         
-        const Json::Val* uri_val = buffer->Find(String(alloc, "uri"));
+        const Json::Val* uri_val = buffer->Find("uri");
         if (!uri_val || !uri_val->IsString()) {
             LOG_ERROR("Was expecting a uri property");
             return false;
         }
         
-        const Json::Val* byte_length_val = buffer->Find(String(alloc, "byteLength"));
+        const Json::Val* byte_length_val = buffer->Find("byteLength");
         if (!byte_length_val || !byte_length_val->IsInteger()) {
             LOG_ERROR("Was expecting a byteLength property");
             return false;
         }
 
-		Path gltf_buffer_path = directory.Join(uri_val->AsString()->View());
-        GltfBuffer out_buf(alloc, gltf_buffer_path, uri_val->AsString()->View(), *byte_length_val->AsInt64());
+		Path gltf_buffer_path = directory.Join(*uri_val->AsString());
+        GltfBuffer out_buf(alloc, gltf_buffer_path, *uri_val->AsString(), *byte_length_val->AsInt64());
+        if (!out_buf.data) {
+            LOG_ERROR("Failed to read buffer %s", gltf_buffer_path.data);
+            return false;
+        }
 
         out_buffers->PushBack(std::move(out_buf));
     }
@@ -631,78 +658,79 @@ TryGetBuffers(Allocator* alloc, const Path& directory, const RobinHashMap<String
 }
 
 static bool
-TryGetAccessors(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
+TryGetAccessors(Allocator* alloc, const Json::Object* gltf_file,
                 const Array<GltfBufferView>& buffer_views, Array<GltfAccessor>* out_accessors)
 {
     assert(alloc);
     assert(gltf_file);
     assert(out_accessors);
 
-    const Json::Val* accessors_val = gltf_file->Find(String(alloc, "accessors"));
+    const Json::Val* accessors_val = gltf_file->Find("accessors");
     if (!accessors_val) {
         LOG_ERROR("Was expecting an accessors array");
         return false;
     }
     
-    const Array<Json::Val>* accessors = accessors_val->AsArray();
+    const Json::ArrayView* accessors = accessors_val->AsArray();
     if (!accessors) {
         LOG_ERROR("Was expecting an accessors array");
         return false;
     }
     
     *out_accessors = Array<GltfAccessor>(alloc);
+    out_accessors->Reserve(accessors->len);
     
     for (size_t i = 0; i < accessors->len; ++i) {
-        const RobinHashMap<String, Json::Val>* accessor = (*accessors)[i].AsObject();
+        const Json::Object* accessor = (*accessors)[i].AsObject();
         if (!accessor)
 		{
             LOG_ERROR("Was expecting a buffer object");
             return false;
         }
         
-        const Json::Val* buffer_view_val = accessor->Find(String(alloc, "bufferView"));
+        const Json::Val* buffer_view_val = accessor->Find("bufferView");
         if (!buffer_view_val || !buffer_view_val->IsInteger())
 		{
             LOG_ERROR("Was expecting a bufferView property");
             return false;
         }
         
-        const Json::Val* component_type_val = accessor->Find(String(alloc, "componentType"));
+        const Json::Val* component_type_val = accessor->Find("componentType");
         if (!component_type_val || !component_type_val->IsInteger())
 		{
             LOG_ERROR("Was expecting a componentType property");
             return false;
         }
 
-        const Json::Val* count_val = accessor->Find(String(alloc, "count"));
+        const Json::Val* count_val = accessor->Find("count");
         if (!count_val || !count_val->IsInteger())
 		{
             LOG_ERROR("Was expecting a componentType property");
             return false;
         }
 
-        const Json::Val* max_val = accessor->Find(String(alloc, "max"));
+        const Json::Val* max_val = accessor->Find("max");
         if (max_val && !max_val->IsArray())
 		{
             LOG_ERROR("Was expecting a max property");
             return false;
         }
 
-        const Json::Val* min_val = accessor->Find(String(alloc, "min"));
+        const Json::Val* min_val = accessor->Find("min");
         if (min_val && !min_val->IsArray())
 		{
             LOG_ERROR("Was expecting a min property");
             return false;
         }
 
-        const Json::Val* type_val = accessor->Find(String(alloc, "type"));
+        const Json::Val* type_val = accessor->Find("type");
         if (!type_val || !type_val->IsString())
 		{
             LOG_ERROR("Was expecting a type property");
             return false;
         }
 
-        const Json::Val* normalized_val = accessor->Find(String(alloc, "normalized"));
+        const Json::Val* normalized_val = accessor->Find("normalized");
         if (normalized_val && !normalized_val->IsBool())
 		{
             LOG_ERROR("Was expecting a normalized property");
@@ -720,9 +748,9 @@ TryGetAccessors(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_fi
             return false;
         }
 
-        if (!TryGetAccessorType(type_val->AsString()->View(), &out_accessor.type))
+        if (!TryGetAccessorType(*type_val->AsString(), &out_accessor.type))
 		{
-            LOG_ERROR("Invalid accessor type %s", type_val->AsString()->data);
+            LOG_ERROR("Invalid accessor type %.*s", (int)type_val->AsString()->len, type_val->AsString()->data);
             return false;
         }
 
@@ -892,9 +920,8 @@ TryGetAccessors(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_fi
 }
 
 static bool
-TryGetTextureRef(Allocator* alloc, const Json::Val* raw_texture_ref, TextureRef* out_texture_ref)
+TryGetTextureRef(const Json::Val* raw_texture_ref, TextureRef* out_texture_ref)
 {
-    assert(alloc);
     assert(out_texture_ref);
 
     if (!raw_texture_ref) {
@@ -906,14 +933,14 @@ TryGetTextureRef(Allocator* alloc, const Json::Val* raw_texture_ref, TextureRef*
         return false;
     }
 
-    const RobinHashMap<String, Json::Val>* texture_ref = raw_texture_ref->AsObject();
+    const Json::Object* texture_ref = raw_texture_ref->AsObject();
 
-    const Json::Val* index = texture_ref->Find(String(alloc, "index"));
+    const Json::Val* index = texture_ref->Find("index");
     if (!index || !index->IsInteger()) {
         return false;
     }
 
-    const Json::Val* tex_coord = texture_ref->Find(String(alloc, "texCoord"));
+    const Json::Val* tex_coord = texture_ref->Find("texCoord");
     if (!tex_coord || !tex_coord->IsInteger()) {
         return false;
     }
@@ -925,46 +952,46 @@ TryGetTextureRef(Allocator* alloc, const Json::Val* raw_texture_ref, TextureRef*
 }
 
 static bool
-TryGetMaterial(Allocator* alloc, const RobinHashMap<String, Json::Val>* raw_material, GltfMaterial* out_material)
+TryGetMaterial(Allocator* alloc, const Json::Object* raw_material, GltfMaterial* out_material)
 {
     assert(alloc);
     assert(out_material);
     assert(raw_material);
     
-    const Json::Val* material_name = raw_material->Find(String(alloc, "name"));
+    const Json::Val* material_name = raw_material->Find("name");
     if (!material_name || !material_name->AsString()) {
         LOG_ERROR("Was expecting material name");
         return false;
     }
 
-    const Json::Val* double_sided_val = raw_material->Find(String(alloc, "doubleSided"));
+    const Json::Val* double_sided_val = raw_material->Find("doubleSided");
     if (double_sided_val && !double_sided_val->AsBool()) {
         LOG_ERROR("Was expecting a doubleSided property");
         return false;
     }
 
-    const Json::Val* normal_texture = raw_material->Find(String(alloc, "normalTexture"));
-    const Json::Val* occlusion_texture = raw_material->Find(String(alloc, "occlusionTexture"));
+    const Json::Val* normal_texture = raw_material->Find("normalTexture");
+    const Json::Val* occlusion_texture = raw_material->Find("occlusionTexture");
     
-    const Json::Val* pbr_params = raw_material->Find(String(alloc, "pbrMetallicRoughness"));
+    const Json::Val* pbr_params = raw_material->Find("pbrMetallicRoughness");
     if (!pbr_params || !pbr_params->AsObject()) {
         LOG_ERROR("Was expecting pbr metallic roughness");
         return false;
     }
 
-    const Json::Val* base_color_texture = pbr_params->AsObject()->Find(String(alloc, "baseColorTexture"));
-    const Json::Val* metallic_roughness_texture = pbr_params->AsObject()->Find(String(alloc, "metallicRoughnessTexture"));
-    const Json::Val* base_color_factor = pbr_params->AsObject()->Find(String(alloc, "baseColorFactor"));
-    const Json::Val* metallic_factor = pbr_params->AsObject()->Find(String(alloc, "metallicFactor"));
-    const Json::Val* roughness_factor = pbr_params->AsObject()->Find(String(alloc, "roughnessFactor"));
+    const Json::Val* base_color_texture = pbr_params->AsObject()->Find("baseColorTexture");
+    const Json::Val* metallic_roughness_texture = pbr_params->AsObject()->Find("metallicRoughnessTexture");
+    const Json::Val* base_color_factor = pbr_params->AsObject()->Find("baseColorFactor");
+    const Json::Val* metallic_factor = pbr_params->AsObject()->Find("metallicFactor");
+    const Json::Val* roughness_factor = pbr_params->AsObject()->Find("roughnessFactor");
 
     GltfMaterial out_mat;
-    out_mat.name = String(alloc, material_name->AsString()->View());
+    out_mat.name = String(alloc, *material_name->AsString());
 	if (double_sided_val) {
 		out_mat.double_sided = *double_sided_val->AsBool();
 	}
 
-    if (!TryGetTextureRef(alloc, base_color_texture, &out_mat.base_color)) {
+    if (!TryGetTextureRef(base_color_texture, &out_mat.base_color)) {
         LOG_ERROR("Failed to get base color texture reference from material");
         return false;
     }
@@ -990,17 +1017,17 @@ TryGetMaterial(Allocator* alloc, const RobinHashMap<String, Json::Val>* raw_mate
         }
     }
 
-    if (!TryGetTextureRef(alloc, metallic_roughness_texture, &out_mat.metallic_roughness)) {
+    if (!TryGetTextureRef(metallic_roughness_texture, &out_mat.metallic_roughness)) {
         LOG_ERROR("Failed to get metallic roughness texture reference from material");
         return false;
     }
 
-    if (!TryGetTextureRef(alloc, normal_texture, &out_mat.normal)) {
+    if (!TryGetTextureRef(normal_texture, &out_mat.normal)) {
         LOG_ERROR("Failed to get normal texture reference from material");
         return false;
     }
 
-    if (!TryGetTextureRef(alloc, occlusion_texture, &out_mat.occlusion)) {
+    if (!TryGetTextureRef(occlusion_texture, &out_mat.occlusion)) {
         LOG_ERROR("Failed to get occlusion texture reference from material");
         return false;
     }
@@ -1010,28 +1037,29 @@ TryGetMaterial(Allocator* alloc, const RobinHashMap<String, Json::Val>* raw_mate
 }
 
 static bool
-TryGetMaterials(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfMaterial>* out_materials)
+TryGetMaterials(Allocator* alloc, const Json::Object* gltf_file, Array<GltfMaterial>* out_materials)
 {
     assert(gltf_file);
     assert(alloc);
     assert(out_materials);
 
-    const Json::Val* materials_val = gltf_file->Find(String(alloc, "materials"));
+    const Json::Val* materials_val = gltf_file->Find("materials");
     if (!materials_val) {
         LOG_ERROR("Was expecting a materials array");
         return false;
     }
     
-    const Array<Json::Val>* materials = materials_val->AsArray();
+    const Json::ArrayView* materials = materials_val->AsArray();
     if (!materials) {
         LOG_ERROR("Was expecting a materials array");
         return false;
     }
 
     *out_materials = Array<GltfMaterial>(alloc);
+    out_materials->Reserve(materials->len);
 
     for (size_t mi = 0; mi < materials->len; ++mi) {
-        const RobinHashMap<String, Json::Val>* raw_material = (*materials)[mi].AsObject();
+        const Json::Object* raw_material = (*materials)[mi].AsObject();
         if (!raw_material) {
             LOG_ERROR("Was expecting a material object");
             return false;
@@ -1050,55 +1078,56 @@ TryGetMaterials(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_fi
 }
 
 static bool
-TryGetImages(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfImage>* out_images)
+TryGetImages(Allocator* alloc, const Json::Object* gltf_file, Array<GltfImage>* out_images)
 {
     assert(gltf_file);
     assert(alloc);
     assert(out_images);
 
-    const Json::Val* images_val = gltf_file->Find(String(alloc, "images"));
+    const Json::Val* images_val = gltf_file->Find("images");
     if (!images_val) {
 		*out_images = Array<GltfImage>(alloc);
         return true;
     }
     
-    const Array<Json::Val>* images = images_val->AsArray();
+    const Json::ArrayView* images = images_val->AsArray();
     if (!images) {
         LOG_ERROR("Was expecting a materials array");
         return false;
     }
 
     *out_images = Array<GltfImage>(alloc);
+    out_images->Reserve(images->len);
 
     for (size_t mi = 0; mi < images->len; ++mi) {
-        const RobinHashMap<String, Json::Val>* raw_image = (*images)[mi].AsObject();
+        const Json::Object* raw_image = (*images)[mi].AsObject();
         if (!raw_image) {
             LOG_ERROR("Was expecting an image object");
             return false;
         }
 
-        const Json::Val* mime_type_val = raw_image->Find(String(alloc, "mimeType"));
+        const Json::Val* mime_type_val = raw_image->Find("mimeType");
         if (!mime_type_val || !mime_type_val->IsString()) {
             LOG_ERROR("Was expecting a mimeType property");
             return false;
         }
 
-        const Json::Val* name_val = raw_image->Find(String(alloc, "name"));
+        const Json::Val* name_val = raw_image->Find("name");
         if (!name_val || !name_val->IsString()) {
             LOG_ERROR("Was expecting a name property");
             return false;
         }
 
-        const Json::Val* uri_val = raw_image->Find(String(alloc, "uri"));
+        const Json::Val* uri_val = raw_image->Find("uri");
         if (!uri_val || !uri_val->IsString()) {
             LOG_ERROR("Was expecting a uri property");
             return false;
         }
 
         GltfImage out_image;
-        out_image.mime_type = String(alloc, mime_type_val->AsString()->View());
-        out_image.name = String(alloc, name_val->AsString()->View());
-        out_image.uri = String(alloc, uri_val->AsString()->View());
+        out_image.mime_type = String(alloc, *mime_type_val->AsString());
+        out_image.name = String(alloc, *name_val->AsString());
+        out_image.uri = String(alloc, *uri_val->AsString());
 
         out_images->PushBack(std::move(out_image));
     }
@@ -1107,52 +1136,53 @@ TryGetImages(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file,
 }
 
 static bool
-TryGetBufferViews(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfBufferView>* out_buffer_views)
+TryGetBufferViews(Allocator* alloc, const Json::Object* gltf_file, Array<GltfBufferView>* out_buffer_views)
 {
     assert(gltf_file);
     assert(alloc);
     assert(out_buffer_views);
 
-    const Json::Val* buffer_views_val = gltf_file->Find(String(alloc, "bufferViews"));
+    const Json::Val* buffer_views_val = gltf_file->Find("bufferViews");
     if (!buffer_views_val) {
         LOG_ERROR("Was expecting a bufferViews array");
         return false;
     }
     
-    const Array<Json::Val>* buffer_views = buffer_views_val->AsArray();
+    const Json::ArrayView* buffer_views = buffer_views_val->AsArray();
     if (!buffer_views) {
         LOG_ERROR("Was expecting a bufferViews array");
         return false;
     }
 
     *out_buffer_views = Array<GltfBufferView>(alloc);
+    out_buffer_views->Reserve(buffer_views->len);
 
     for (size_t mi = 0; mi < buffer_views->len; ++mi) {
-        const RobinHashMap<String, Json::Val>* raw_buffer_view = (*buffer_views)[mi].AsObject();
+        const Json::Object* raw_buffer_view = (*buffer_views)[mi].AsObject();
         if (!raw_buffer_view) {
             LOG_ERROR("Was expecting a bufferView object");
             return false;
         }
 
-        const Json::Val* byte_length_val = raw_buffer_view->Find(String(alloc, "byteLength"));
+        const Json::Val* byte_length_val = raw_buffer_view->Find("byteLength");
         if (!byte_length_val || !byte_length_val->IsInteger()) {
             LOG_ERROR("Was expecting a byteLength property");
             return false;
         }
 
-        const Json::Val* buffer_val = raw_buffer_view->Find(String(alloc, "buffer"));
+        const Json::Val* buffer_val = raw_buffer_view->Find("buffer");
         if (!buffer_val || !buffer_val->IsInteger()) {
             LOG_ERROR("Was expecting a buffer property");
             return false;
         }
 
-        const Json::Val* byte_offset_val = raw_buffer_view->Find(String(alloc, "byteOffset"));
+        const Json::Val* byte_offset_val = raw_buffer_view->Find("byteOffset");
         if (!byte_offset_val || !byte_offset_val->IsInteger()) {
             LOG_ERROR("Was expecting a byteOffset property");
             return false;
         }
 
-        const Json::Val* target_val = raw_buffer_view->Find(String(alloc, "target"));
+        const Json::Val* target_val = raw_buffer_view->Find("target");
         if (target_val && !target_val->IsInteger()) {
             LOG_ERROR("Was expecting a target property");
             return false;
@@ -1181,40 +1211,41 @@ TryGetBufferViews(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_
 }
 
 static bool
-TryGetTextures(Allocator* alloc, const RobinHashMap<String, Json::Val>* gltf_file, Array<GltfTexture>* out_textures)
+TryGetTextures(Allocator* alloc, const Json::Object* gltf_file, Array<GltfTexture>* out_textures)
 {
     assert(alloc);
     assert(gltf_file);
     assert(out_textures);
 
-    const Json::Val* textures_val = gltf_file->Find(String(alloc, "textures"));
+    const Json::Val* textures_val = gltf_file->Find("textures");
     if (!textures_val) {
         LOG_ERROR("Was expecting a textures array");
         return false;
     }
     
-    const Array<Json::Val>* textures = textures_val->AsArray();
+    const Json::ArrayView* textures = textures_val->AsArray();
     if (!textures) {
         LOG_ERROR("Was expecting a textures array");
         return false;
     }
 
     *out_textures = Array<GltfTexture>(alloc);
+    out_textures->Reserve(textures->len);
 
     for (size_t mi = 0; mi < textures->len; ++mi) {
-        const RobinHashMap<String, Json::Val>* raw_texture = (*textures)[mi].AsObject();
+        const Json::Object* raw_texture = (*textures)[mi].AsObject();
         if (!raw_texture) {
             LOG_ERROR("Was expecting a texture object");
             return false;
         }
 
-        const Json::Val* source_val = raw_texture->Find(String(alloc, "source"));
+        const Json::Val* source_val = raw_texture->Find("source");
         if (!source_val || !source_val->IsInteger()) {
             LOG_ERROR("Was expecting a source property");
             return false;
         }
 
-        const Json::Val* sampler_val = raw_texture->Find(String(alloc, "sampler"));
+        const Json::Val* sampler_val = raw_texture->Find("sampler");
         if (sampler_val && !sampler_val->IsInteger()) {
             LOG_ERROR("Was expecting a sampler property");
             return false;
@@ -1325,30 +1356,30 @@ struct LoadedGltfBuffer
 #endif
 
 static bool 
-TryGetAsset(Allocator* alloc, Allocator* scratch_alloc, const RobinHashMap<String, Json::Val>* gltf_file, GltfAsset* out_asset)
+TryGetAsset(Allocator* alloc, const Json::Object* gltf_file, GltfAsset* out_asset)
 {
 	ASSERT(out_asset, "should not be null");
-    const Json::Val* asset_val = gltf_file->Find(String(scratch_alloc, "asset"));
+    const Json::Val* asset_val = gltf_file->Find("asset");
 
     if (!asset_val) {
         LOG_ERROR("'asset' entry was not found");
         return false;
     }
     
-    const RobinHashMap<String, Json::Val>* asset = asset_val->AsObject();
+    const Json::Object* asset = asset_val->AsObject();
     if (!asset) {
         LOG_ERROR("'asset' should be an object");
         return false;
     }
 
-	const Json::Val* version_val = asset->Find(String(scratch_alloc, "version"));
+	const Json::Val* version_val = asset->Find("version");
 	if (!version_val || !version_val->IsString()) {
         LOG_ERROR("Could not parse 'version' entry in 'asset'");
         return false;
 	}
 
 	*out_asset = GltfAsset();
-	out_asset->version = String(alloc, version_val->AsString()->View());
+	out_asset->version = String(alloc, *version_val->AsString());
 
 	return true;
 }
@@ -1358,81 +1389,97 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
 {
     size_t size;
     uint8_t* data = FileSystem::LoadFileToMemory(scratch_allocator, path, &size);
-    assert(data);
+    if (!data) {
+        LOG_ERROR("Failed to read GLTF2 file %s", path.data);
+        return Model(alloc);
+    }
 
 	Path directory = path.GetDir();
     
+    // The file stays loaded while the document is used, so the strings can point into it.
     Json::Document doc(scratch_allocator);
-    doc.Parse(data, size);
+    doc.ParseInSitu(data, size);
     if (doc.HasParseErrors() || !doc.root_val.IsObject()) {
         LOG_ERROR("GLTF2 file is corrupt: %s", doc.GetErrorStr());
         assert(false);
+        return Model(alloc);
     }
 
     assert(doc.root_val.type == Json::Type::Object);
     
-    const RobinHashMap<String, Json::Val>* root = doc.root_val.AsObject();
+    const Json::Object* root = doc.root_val.AsObject();
     if (!root) {
         LOG_ERROR("Was expecting root to be an object");
         assert(false);
+        return Model(alloc);
     }
 
 	GltfAsset asset;
-    if (!TryGetAsset(alloc, scratch_allocator, root, &asset)) {
+    if (!TryGetAsset(scratch_allocator, root, &asset)) {
         LOG_ERROR("This GLTF file is not supported");
         assert(false);
+        return Model(alloc);
     }
 
 	if (asset.version != "2.0") {
 		LOG_ERROR("Only version 2.0 of glTF is supported");
 		assert(false);
+		return Model(alloc);
 	}
 
     Array<GltfBuffer> buffers;
-    if (!TryGetBuffers(alloc, directory, root, &buffers)) {
+    if (!TryGetBuffers(scratch_allocator, directory, root, &buffers)) {
         LOG_ERROR("Was expecting a buffers array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfMesh> meshes;
-    if (!TryGetMeshes(alloc, root, &meshes)) {
+    if (!TryGetMeshes(scratch_allocator, root, &meshes)) {
         LOG_ERROR("Was expecting a meshes array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfNode> nodes;
-    if (!TryGetNodes(alloc, root, &nodes)) {
+    if (!TryGetNodes(scratch_allocator, root, &nodes)) {
         LOG_ERROR("Was expecting a nodes array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfMaterial> materials;
-    if (!TryGetMaterials(alloc, root, &materials)) {
+    if (!TryGetMaterials(scratch_allocator, root, &materials)) {
         LOG_ERROR("Was expecting a materials array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfImage> images;
-    if (!TryGetImages(alloc, root, &images)) {
+    if (!TryGetImages(scratch_allocator, root, &images)) {
         LOG_ERROR("Was expecting an images array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfBufferView> buffer_views;
-    if (!TryGetBufferViews(alloc, root, &buffer_views)) {
+    if (!TryGetBufferViews(scratch_allocator, root, &buffer_views)) {
         LOG_ERROR("Was expecting a bufferViews array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfAccessor> accessors;
-    if (!TryGetAccessors(alloc, root, buffer_views, &accessors)) {
+    if (!TryGetAccessors(scratch_allocator, root, buffer_views, &accessors)) {
         LOG_ERROR("Was expecting an accessors array");
         assert(false);
+        return Model(alloc);
     }
 
     Array<GltfTexture> textures;
-    if (!TryGetTextures(alloc, root, &textures)) {
+    if (!TryGetTextures(scratch_allocator, root, &textures)) {
         ASSERT(false, "Was expecting a bufferViews array");
+        return Model(alloc);
     }
 
     // A node inside gltf will be represented as a model.
@@ -1441,7 +1488,7 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
     const GltfNode& node = nodes[0];
 
     Model model(alloc);
-    model.name = SID(node.name.data);
+    model.name = SID(node.name.GetData());
     model.rotation = node.rotation;
     model.translation = node.translation;
     model.scale = 1.0f;
@@ -1452,48 +1499,48 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
     for (size_t mi = 0; mi < materials.len; ++mi) {
         const GltfMaterial& gltf_material = materials[mi];
 
-        Material* material = resource_manager->allocator->New<Material>(resource_manager->allocator);
-        material->name = SID(gltf_material.name.data);
-        material->shader = resource_manager->GetShader(SID("pbr.glsl"));
-        material->shader->Bind();
+        // Only materials are added to the material pool in this loop, so the pointer stays valid
+        // until the next iteration.
+        Material* material = resource_manager->GetMaterial(
+            resource_manager->CreateMaterial(SID(gltf_material.name.GetData()), resource_manager->GetShader(SID("pbr.glsl"))));
         ASSERT(material->shader, "shader is not loaded!");
+        material->shader->Bind();
 
         if (gltf_material.base_color.IsValid()) {
             const GltfTexture& gltf_base_image_texture = textures[gltf_material.base_color.index];
             const GltfImage& gltf_base_image = images[gltf_base_image_texture.source];
-            Texture* texture = gltf_base_image.LoadAsAlbedo(resource_manager);
-            material->AddValue(SID("u_albedo_texture"), texture);
+            TextureHandle texture = gltf_base_image.LoadAsAlbedo(resource_manager);
+            material->AddValue("u_albedo_texture"_sid, texture);
         }
 
         if (gltf_material.metallic_roughness.IsValid()) {
             const GltfImage& gltf_base_image = images[gltf_material.metallic_roughness.index];
-            Texture* texture = gltf_base_image.LoadInLinearSpace(resource_manager);
-            material->AddValue(SID("u_metallic_roughness_texture"), texture);
+            TextureHandle texture = gltf_base_image.LoadInLinearSpace(resource_manager);
+            material->AddValue("u_metallic_roughness_texture"_sid, texture);
         }
 
         if (gltf_material.normal.IsValid()) {
             const GltfImage& gltf_base_image = images[gltf_material.normal.index];
-            Texture* texture = gltf_base_image.LoadInLinearSpace(resource_manager);
-            material->AddValue(SID("u_normal_texture"), texture);
+            TextureHandle texture = gltf_base_image.LoadInLinearSpace(resource_manager);
+            material->AddValue("u_normal_texture"_sid, texture);
         }
 
         if (gltf_material.occlusion.IsValid()) {
             const GltfImage& gltf_base_image = images[gltf_material.normal.index];
-            Texture* texture = gltf_base_image.LoadInLinearSpace(resource_manager);
-            material->AddValue(SID("u_occlusion_texture"), texture);
+            TextureHandle texture = gltf_base_image.LoadInLinearSpace(resource_manager);
+            material->AddValue("u_occlusion_texture"_sid, texture);
         }
 
-        material->AddValue(SID("u_metallic_factor"), gltf_material.metallic_factor);
-        material->AddValue(SID("u_roughness_factor"), gltf_material.roughness_factor);
+        material->AddValue("u_metallic_factor"_sid, gltf_material.metallic_factor);
+        material->AddValue("u_roughness_factor"_sid, gltf_material.roughness_factor);
 
         material->shader->Unbind();
-        resource_manager->materials.Add(material->name, material);
     }
 
     // start loading the triangle mesh
-    auto mesh = resource_manager->allocator->New<TriangleMesh>(resource_manager->allocator);
-    mesh->name = SID(gltf_mesh.name.data);
-    mesh->sub_meshes = Array<SubMesh>(resource_manager->allocator);
+    const MeshHandle mesh_handle = resource_manager->CreateMesh(SID(gltf_mesh.name.GetData()));
+    TriangleMesh* mesh = resource_manager->GetMesh(mesh_handle);
+    mesh->sub_meshes.Reserve(gltf_mesh.primitives.len);
 
     for (size_t pi = 0; pi < gltf_mesh.primitives.len; ++pi) {
         const GltfPrimitive& primitive = gltf_mesh.primitives[pi];
@@ -1523,22 +1570,22 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
             }
         }
 
-        LOG_DEBUG("Gltf2 model is using an index buffer for mesh %s", gltf_mesh.name.data);
+        LOG_DEBUG("Gltf2 model is using an index buffer for mesh %s", gltf_mesh.name.GetData());
 
         // Each primitive is a submesh in the engine currently.
         // TODO: improve how nodes are represented in the engine
         SubMesh submesh;
-        submesh.material = resource_manager->GetMaterial(SID(material.name.data));
+        submesh.material = resource_manager->FindMaterial(SID(material.name.GetData()));
         submesh.start_index = 0;
         submesh.num_indices = indices_accessor.count;
-        ASSERT(submesh.material, "material should exist");
+        ASSERT(submesh.material.IsValid(), "material should exist");
 
         //
         // We will combine the primitive buffer views into one buffer in order to send it to the GPU 
         //
 
         // position
-        const int32_t* position_accessor_index = primitive.attributes.Find(String(scratch_allocator, "POSITION"));
+        const int32_t* position_accessor_index = primitive.FindAttribute("POSITION");
         ASSERT(position_accessor_index, "should have a position accessor");
         const GltfAccessor& position_accessor = accessors[*position_accessor_index];
         ASSERT(position_accessor.type == AccessorType::Vec3, "should be vec3");
@@ -1546,7 +1593,7 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
         const GltfBufferView& position_buffer_view = buffer_views[position_accessor.buffer_view_index];
 
         // normal
-        const int32_t* normal_accessor_index = primitive.attributes.Find(String(scratch_allocator, "NORMAL"));
+        const int32_t* normal_accessor_index = primitive.FindAttribute("NORMAL");
         ASSERT(normal_accessor_index, "should have a normal accessor");
         const GltfAccessor& normal_accessor = accessors[*normal_accessor_index];
         ASSERT(normal_accessor.type == AccessorType::Vec3, "should be vec3");
@@ -1554,7 +1601,7 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
         const GltfBufferView& normal_buffer_view = buffer_views[normal_accessor.buffer_view_index];
 
         // tangent
-        const int32_t* tangent_accessor_index = primitive.attributes.Find(String(scratch_allocator, "TANGENT"));
+        const int32_t* tangent_accessor_index = primitive.FindAttribute("TANGENT");
         ASSERT(tangent_accessor_index, "should have a tangent accessor");
         const GltfAccessor& tangent_accessor = accessors[*tangent_accessor_index];
         ASSERT(tangent_accessor.type == AccessorType::Vec4, "should be vec4");
@@ -1562,7 +1609,7 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
         const GltfBufferView& tangent_buffer_view = buffer_views[tangent_accessor.buffer_view_index];
 
         // tex coords
-        const int32_t* texcoord0_accessor_index = primitive.attributes.Find(String(scratch_allocator, "TEXCOORD_0"));
+        const int32_t* texcoord0_accessor_index = primitive.FindAttribute("TEXCOORD_0");
         ASSERT(texcoord0_accessor_index, "should have a tex coord 0 accessor");
         const GltfAccessor& texcoord0_accessor = accessors[*texcoord0_accessor_index];
         ASSERT(texcoord0_accessor.type == AccessorType::Vec2, "should be vec2");
@@ -1604,7 +1651,7 @@ ImportGltf2Model(Allocator* alloc, Allocator* scratch_allocator, const Path& pat
         mesh->sub_meshes.PushBack(std::move(submesh));
     }
 
-    model.meshes.PushBack(std::move(mesh));
+    model.meshes.PushBack(mesh_handle);
 
     scratch_allocator->Deallocate(data);
     return model;
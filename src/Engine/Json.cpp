@@ -1,462 +1,468 @@
 #include "Han/Json.hpp"
+#include "Han/Collections/Array.hpp"
 #include "Han/Collections/StringView.hpp"
 #include "Han/FileSystem.hpp"
 #include "Han/Logger.hpp"
 #include "Han/Utils.hpp"
-#include <cctype>
-#include <array>
 #include <inttypes.h>
 
-#define JSON_TOKENS \
-        JT(TokenType_Invalid = 0, "Invalid"),             \
-        JT(TokenType_String, "String"),           \
-        JT(TokenType_Integer, "Integer"),                 \
-        JT(TokenType_Real, "Real"),                 \
-        JT(TokenType_OpenCurlyBraces, "Open Curly Braces ({)"),    \
-        JT(TokenType_CloseCurlyBraces, "Close Curly Braces (})"),  \
-        JT(TokenType_OpenBrackets, "Open Brackets ([)"),    \
-        JT(TokenType_CloseBrackets, "Close Brackets (])"),  \
-        JT(TokenType_Comma, "Comma (,)"), \
-        JT(TokenType_Colon, "Colon (:)"), \
-        JT(TokenType_Boolean, "Boolean (true or false)"), \
-        JT(TokenType_Null, "Null"),
-
-static const char* TokenNames[] =
+// The text is parsed in a single pass, and the values are built while it is read.
+// The values and members of the arrays and objects that are being parsed are pushed on the stacks
+// of the parser, and copied to the memory of the document in one go when their array or object
+// ends, so the document gets exactly sized blocks.
+struct Parser
 {
-#define JT(e, s) s
-	JSON_TOKENS
-#undef JT
+    Json::Document* doc;
+    const uint8_t* it;
+    const uint8_t* end;
+    int depth;
+    Array<Json::Val> values;
+    Array<Json::Member> members;
 };
 
-enum TokenType
+// Deeper documents are rejected instead of running out of stack.
+static constexpr int kMaxDepth = 512;
+
+static const char* ParseValue(Parser* parser, Json::Val* out_val);
+
+static bool
+AreEqual(StringView a, StringView b)
 {
-#define JT(e, s) e
-    JSON_TOKENS
-#undef JT
-};
+    return a.len == b.len && (a.len == 0 || memcmp(a.data, b.data, a.len) == 0);
+}
 
-struct Token
+const Json::Val*
+Json::Object::Find(StringView key) const
 {
-    TokenType type;
-    StringView str;
-
-    Token(TokenType type, const uint8_t* str, size_t len)
-        : type(type)
-        , str((char*)str, len)
-    {
-	}
-
-    Token(TokenType type)
-        : type(type)
-        , str()
-    {}
-};
+    if (index_cap == 0) {
+        for (uint32_t i = 0; i < len; ++i) {
+            if (AreEqual(members[i].key, key)) {
+                return &members[i].val;
+            }
+        }
+        return nullptr;
+    }
 
-static Array<Token> Tokenize(Allocator* allocator, const char* str, size_t str_size, const char** err_str);
-static const char* ParseArray(Allocator* allocator,
-                              const Array<Token>& tokens,
-                              size_t* start,
-                              Array<Json::Val>* array);
-static const char* ParseObject(Allocator* allocator,
-                               const Array<Token>& tokens,
-                               size_t* start,
-                               RobinHashMap<String, Json::Val>* obj);
+    const uint32_t* index = GetIndex();
+    const size_t mask = index_cap - 1;
+    for (size_t slot = HashBytes(key.data, key.len) & mask; index[slot] != 0; slot = (slot + 1) & mask) {
+        const Member& member = members[index[slot] - 1];
+        if (AreEqual(member.key, key)) {
+            return &member.val;
+        }
+    }
+    return nullptr;
+}
 
-void
-Json::Document::Parse(const char* json_str)
+static const char* kOutOfMemoryError = "Not enough memory for the json document";
+
+static const char*
+MakeArray(Json::Document* doc, const Json::Val* values, size_t len, Json::ArrayView* out_array)
 {
-    assert(json_str);
-    Parse((uint8_t*)json_str, strlen(json_str));
+    Json::ArrayView array = {nullptr, len};
+    if (len > 0) {
+        Json::Val* data = (Json::Val*)doc->AllocateBlock(len * sizeof(Json::Val), alignof(Json::Val));
+        if (!data) {
+            return kOutOfMemoryError;
+        }
+        memcpy(data, values, len * sizeof(Json::Val));
+        array.data = data;
+    }
+    *out_array = array;
+    return nullptr;
 }
 
-static size_t
-GetTokensLeft(const Array<Token>& tokens, size_t current)
+static const char*
+MakeObject(Json::Document* doc, const Json::Member* members, size_t len, Json::Object* out_obj)
 {
-    return tokens.len - current;
+    Json::Object obj = {nullptr, (uint32_t)len, 0};
+    if (len == 0) {
+        *out_obj = obj;
+        return nullptr;
+    }
+
+    if (len > Json::Object::kMaxLinearSearchLen) {
+        // At most half of the slots are used.
+        obj.index_cap = 16;
+        while (obj.index_cap < 2 * len) {
+            obj.index_cap *= 2;
+        }
+    }
+
+    Json::Member* data = (Json::Member*)doc->AllocateBlock(len * sizeof(Json::Member) + obj.index_cap * sizeof(uint32_t),
+                                                           alignof(Json::Member));
+    if (!data) {
+        return kOutOfMemoryError;
+    }
+    memcpy(data, members, len * sizeof(Json::Member));
+    obj.members = data;
+
+    if (obj.index_cap > 0) {
+        uint32_t* index = (uint32_t*)(data + len);
+        memset(index, 0, obj.index_cap * sizeof(uint32_t));
+        const size_t mask = obj.index_cap - 1;
+        for (uint32_t i = 0; i < len; ++i) {
+            size_t slot = HashBytes(data[i].key.data, data[i].key.len) & mask;
+            while (index[slot] != 0 && !AreEqual(data[index[slot] - 1].key, data[i].key)) {
+                slot = (slot + 1) & mask;
+            }
+            // With duplicated keys, the first one is found, as with the linear search.
+            if (index[slot] == 0) {
+                index[slot] = i + 1;
+            }
+        }
+    }
+    *out_obj = obj;
+    return nullptr;
 }
 
-static const char*
-ParseString(Allocator* allocator, const Array<Token>& tokens, size_t* start, String* str)
+
+static bool
+IsWhitespace(uint8_t c)
 {
-    assert(str);
-    assert(start);
-    assert(start > (size_t*)0);
-    assert(allocator);
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
 
-    const size_t num_key_tokens = 1;
-    if (GetTokensLeft(tokens, *start) < num_key_tokens) {
-        return "Was expecting a string";
+static bool
+IsDigit(uint8_t c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static void
+EatWhitespaces(Parser* parser)
+{
+    while (parser->it < parser->end && IsWhitespace(*parser->it)) {
+        ++parser->it;
     }
+}
 
-    if (tokens[*start].type == TokenType_String)
-    {
-        *str = String(allocator, tokens[*start].str);
-        ++(*start);
-        return nullptr;
+static void
+EatDigits(Parser* parser)
+{
+    while (parser->it < parser->end && IsDigit(*parser->it)) {
+        ++parser->it;
     }
-    else
-    {
-        return "Was expecting a json string";
+}
+
+// Returns true and skips the literal when the text continues with it.
+static bool
+EatLiteral(Parser* parser, const char* literal, size_t len)
+{
+    if ((size_t)(parser->end - parser->it) < len || memcmp(parser->it, literal, len) != 0) {
+        return false;
     }
+    parser->it += len;
+    return true;
 }
 
+// The opening double quote should have been skipped. Escape sequences are skipped over, but
+// are kept as they are in the string.
 static const char*
-ParseObject(Allocator* allocator, const Array<Token>& tokens, size_t* start, RobinHashMap<String, Json::Val>* obj)
+ParseString(Parser* parser, StringView* out_str)
 {
-    assert(start);
-    assert(obj);
-    
-    const size_t tokens_left = tokens.len - *start;
-    if (tokens_left < 2) {
-        return "Invalid json object";
+    const uint8_t* start = parser->it;
+    while (parser->it < parser->end && *parser->it != '"') {
+        if (*parser->it == '\\') {
+            ++parser->it;
+        }
+        ++parser->it;
     }
+    if (parser->it >= parser->end) {
+        return "string does not end with a double quote";
+    }
+
+    *out_str = StringView((const char*)start, (size_t)(parser->it - start));
+    ++parser->it; // the closing double quote
+    return nullptr;
+}
 
-    if (tokens[*start].type != TokenType_OpenCurlyBraces) {
-        return "object did not start with curly braces";
+static const char*
+ParseNumber(Parser* parser, Json::Val* out_val)
+{
+    const uint8_t* start = parser->it;
+    if (*parser->it == '-') {
+        ++parser->it;
+    }
+    if (parser->it >= parser->end || !IsDigit(*parser->it)) {
+        return "Invalid number";
+    }
+    EatDigits(parser);
+
+    bool real = false;
+    if (parser->it < parser->end && *parser->it == '.') {
+        // Number is a float, thus we have to take into account the fractional part
+        ++parser->it;
+        if (parser->it >= parser->end || !IsDigit(*parser->it)) {
+            return "Invalid number";
+        }
+        EatDigits(parser);
+        real = true;
     }
 
-    *obj = RobinHashMap<String, Json::Val>(allocator, 32);
-    size_t curr = *start + 1; // advance one, since the current one is an open curly brace
+    if (parser->it < parser->end && (*parser->it == 'e' || *parser->it == 'E')) {
+        // If the number is in exponential notation, we parse it as well.
+        ++parser->it;
+        if (parser->it < parser->end && (*parser->it == '-' || *parser->it == '+')) {
+            ++parser->it;
+        }
+        if (parser->it >= parser->end || !IsDigit(*parser->it)) {
+            return "Invalid exponent";
+        }
+        EatDigits(parser);
+        real = true;
+    }
 
-    if (tokens[curr].type == TokenType_CloseCurlyBraces) {
-        ++curr;
-        *start = curr;
-        return nullptr;
+    const size_t len = (size_t)(parser->it - start);
+    if (real) {
+        *out_val = Json::Val(Utils::ParseDouble(start, len));
+    } else {
+        *out_val = Json::Val(Utils::ParseInt64(start, len));
+    }
+    return nullptr;
+}
+
+// The opening curly brace should have been skipped.
+static const char*
+ParseObject(Parser* parser, Json::Object* obj)
+{
+    assert(obj);
+
+    EatWhitespaces(parser);
+    if (parser->it < parser->end && *parser->it == '}') {
+        ++parser->it;
+        return MakeObject(parser->doc, nullptr, 0, obj);
     }
 
+    // The members of the object go after the ones of the objects that contain it.
+    const size_t first_member = parser->members.len;
     for (;;) {
         // Now, parse a given key of the object
-        String key;
-        const char* err_msg = ParseString(allocator, tokens, &curr, &key);
+        if (parser->it >= parser->end || *parser->it != '"') {
+            return "Was expecting a json string";
+        }
+        ++parser->it;
+        StringView key;
+        const char* err_msg = ParseString(parser, &key);
         if (err_msg) {
             return err_msg;
         }
 
         // Now a colon should be here
-        if (tokens[curr].type != TokenType_Colon) {
+        EatWhitespaces(parser);
+        if (parser->it >= parser->end || *parser->it != ':') {
             return "Expecting a colon after key in object";
         }
-        ++curr;
+        ++parser->it;
 
         // Now, parse the key value
-        switch (tokens[curr].type) {
-            case TokenType_Boolean: {
-                Json::Val boolean((tokens[curr].str == "true") ? true : false);
-                (*obj).Add(std::move(key), std::move(boolean));
-                ++curr;
-            } break;
-            case TokenType_Null: {
-                (*obj).Add(std::move(key), Json::Val());
-                ++curr;
-            } break;
-            case TokenType_Integer: {
-                int64_t val = Utils::ParseInt64((const uint8_t*)tokens[curr].str.data, tokens[curr].str.len);
-                (*obj).Add(std::move(key), Json::Val(val));
-                ++curr;
-            } break;
-            case TokenType_Real: {
-                double val = Utils::ParseDouble((const uint8_t*)tokens[curr].str.data, tokens[curr].str.len);
-                (*obj).Add(std::move(key), Json::Val(val));
-                ++curr;
-            } break;
-            case TokenType_OpenCurlyBraces: {
-                RobinHashMap<String, Json::Val> inner_obj;
-                const char* err_msg = ParseObject(allocator, tokens, &curr, &inner_obj);
-                if (err_msg) {
-                    return err_msg;
-                }
-                (*obj).Add(std::move(key), Json::Val(std::move(inner_obj)));
-            } break;
-            case TokenType_OpenBrackets: {
-                Array<Json::Val> inner_array;
-                const char* err_msg = ParseArray(allocator, tokens, &curr, &inner_array);
-                if (err_msg) {
-                    return err_msg;
-                }
-                (*obj).Add(std::move(key), Json::Val(std::move(inner_array)));
-            } break;
-            case TokenType_String: {
-                String string_val;
-                const char* err_msg = ParseString(allocator, tokens, &curr, &string_val);
-                if (err_msg) {
-                    return err_msg;
-                }
-                (*obj).Add(std::move(key), Json::Val(std::move(string_val)));
-            } break;
-            default: {
-                LOG_ERROR("Was not expecting token %s inside object", tokens[curr].str.data);
-            } break;
+        Json::Val val;
+        err_msg = ParseValue(parser, &val);
+        if (err_msg) {
+            return err_msg;
         }
+        parser->members.PushBack(Json::Member{key, val});
 
-        if (tokens[curr].type == TokenType_Comma) {
+        EatWhitespaces(parser);
+        if (parser->it < parser->end && *parser->it == ',') {
             // a comma was found, more items to parse
-            ++curr;
-        } else if (tokens[curr].type != TokenType_CloseCurlyBraces) {
-            return "Was expecting a comma after a value inside object or a closing curly brace";
-        } else {
-            ++curr;
+            ++parser->it;
+            EatWhitespaces(parser);
+        } else if (parser->it < parser->end && *parser->it == '}') {
+            ++parser->it;
             break;
+        } else {
+            return "Was expecting a comma after a value inside object or a closing curly brace";
         }
     }
 
-    *start = curr;
-    return nullptr;
+    const char* err_msg = MakeObject(parser->doc, parser->members.data + first_member, parser->members.len - first_member, obj);
+    parser->members.len = first_member;
+    return err_msg;
 }
 
+// The opening bracket should have been skipped.
 static const char*
-ParseArray(Allocator* allocator, const Array<Token>& tokens, size_t* start, Array<Json::Val>* array)
+ParseArray(Parser* parser, Json::ArrayView* array)
 {
-    assert(start);
     assert(array);
-    
-    const size_t tokens_left = tokens.len - *start;
-    if (tokens_left < 2) {
-        return "Invalid json array";
-    }
 
-    if (tokens[*start].type != TokenType_OpenBrackets) {
-        return "array did not start with open bracket";
-    }
-
-    *array = Array<Json::Val>(allocator);
-    size_t curr = *start + 1; // advance one, since the current one is an open bracket
-
-    if (tokens[curr].type == TokenType_CloseBrackets) {
-        ++curr;
-        *start = curr;
-        return nullptr;
+    EatWhitespaces(parser);
+    if (parser->it < parser->end && *parser->it == ']') {
+        ++parser->it;
+        return MakeArray(parser->doc, nullptr, 0, array);
     }
 
+    // The values of the array go after the ones of the arrays that contain it.
+    const size_t first_value = parser->values.len;
     for (;;) {
         // Now, parse a value of the array
-        switch (tokens[curr].type) {
-            case TokenType_Boolean: {
-                Json::Val boolean((tokens[curr].str == "true") ? true : false);
-                (*array).PushBack(std::move(boolean));
-                ++curr;
-            } break;
-            case TokenType_Null: {
-                (*array).PushBack(Json::Val());
-                ++curr;
-            } break;
-            case TokenType_Integer: {
-                int64_t val = Utils::ParseInt64((const uint8_t*)tokens[curr].str.data, tokens[curr].str.len);
-                (*array).PushBack(Json::Val(val));
-                ++curr;
-            } break;
-            case TokenType_Real: {
-                double val = Utils::ParseDouble((const uint8_t*)tokens[curr].str.data, tokens[curr].str.len);
-                (*array).PushBack(Json::Val(val));
-                ++curr;
-            } break;
-            case TokenType_OpenCurlyBraces: {
-                RobinHashMap<String, Json::Val> inner_obj;
-                const char* err_msg = ParseObject(allocator, tokens, &curr, &inner_obj);
-                if (err_msg) {
-                    return err_msg;
-                }
-                (*array).PushBack(Json::Val(std::move(inner_obj)));
-            } break;
-            case TokenType_OpenBrackets: {
-                Array<Json::Val> inner_array;
-                const char* err_msg = ParseArray(allocator, tokens, &curr, &inner_array);
-                if (err_msg) {
-                    return err_msg;
-                }
-                (*array).PushBack(Json::Val(std::move(inner_array)));
-            } break;
-            case TokenType_String: {
-                String string_val;
-                const char* err_msg = ParseString(allocator, tokens, &curr, &string_val);
-                if (err_msg) {
-                    return err_msg;
-                }
-                (*array).PushBack(Json::Val(std::move(string_val)));
-            } break;
-            default: {
-                LOG_ERROR("Was not expecting token %s inside object", tokens[curr].str.data);
-            } break;
+        Json::Val val;
+        const char* err_msg = ParseValue(parser, &val);
+        if (err_msg) {
+            return err_msg;
         }
+        parser->values.PushBack(val);
 
-        if (tokens[curr].type == TokenType_Comma) {
+        EatWhitespaces(parser);
+        if (parser->it < parser->end && *parser->it == ',') {
             // a comma was found, there are more items to parse
-            ++curr;
-        } else if (tokens[curr].type != TokenType_CloseBrackets) {
-            return "Was expecting a comma after a value inside array";
-        } else {
-            ++curr;
+            ++parser->it;
+        } else if (parser->it < parser->end && *parser->it == ']') {
+            ++parser->it;
             break;
+        } else {
+            return "Was expecting a comma after a value inside array";
         }
     }
 
-    *start = curr;
-    return nullptr;
+    const char* err_msg = MakeArray(parser->doc, parser->values.data + first_value, parser->values.len - first_value, array);
+    parser->values.len = first_value;
+    return err_msg;
 }
 
-void
-Json::Document::Parse(uint8_t* data, size_t size)
+static const char*
+ParseValue(Parser* parser, Json::Val* out_val)
 {
-    assert(allocator != nullptr);
-    assert(data != nullptr);
-    assert(size > 0);
-    
-    const char* err_str = nullptr;
-    Array<Token> tokens = Tokenize(allocator, (char*)data, size, &err_str);
-    
-    if (err_str) {
-        this->parse_error = String(allocator, err_str);
-        return;
+    EatWhitespaces(parser);
+    if (parser->it >= parser->end) {
+        return "Was expecting a value";
     }
-    
-    if (tokens.len < 2) {
-        this->parse_error = String(allocator, "Invalid JSON string");
-        return;
-    }
-    
-    if (tokens[0].type == TokenType_OpenBrackets) {
-        // Parse an array
-        size_t it = 0;
-        Array<Val> array;
-        const char* err_str = ParseArray(allocator, tokens, &it, &array);
-        if (err_str) {
-            this->parse_error = String(allocator, err_str);
-        } else {
-            assert(it == tokens.len);
-            root_val.type = Type::Array;
-            root_val.values.array = std::move(array);
+
+    const uint8_t c = *parser->it;
+    if (c == '{' || c == '[') {
+        if (parser->depth == kMaxDepth) {
+            return "Json document is nested too deeply";
         }
-    } else if (tokens[0].type == TokenType_OpenCurlyBraces) {
-        // Parse an object
-        size_t it = 0;
-        RobinHashMap<String, Val> obj;
-        const char* err_str = ParseObject(allocator, tokens, &it, &obj);
-        if (err_str) {
-            this->parse_error = String(allocator, err_str);
+        ++parser->it;
+        ++parser->depth;
+        const char* err_msg;
+        if (c == '{') {
+            Json::Object obj = {};
+            err_msg = ParseObject(parser, &obj);
+            *out_val = Json::Val(obj);
         } else {
-            assert(it == tokens.len);
-            root_val.type = Type::Object;
-            root_val.values.object = std::move(obj);
+            Json::ArrayView array = {};
+            err_msg = ParseArray(parser, &array);
+            *out_val = Json::Val(array);
         }
+        --parser->depth;
+        return err_msg;
+    } else if (c == '"') {
+        ++parser->it;
+        StringView str;
+        const char* err_msg = ParseString(parser, &str);
+        *out_val = Json::Val(str);
+        return err_msg;
+    } else if (IsDigit(c) || c == '-') {
+        return ParseNumber(parser, out_val);
+    } else if (EatLiteral(parser, "true", 4)) {
+        *out_val = Json::Val(true);
+    } else if (EatLiteral(parser, "false", 5)) {
+        *out_val = Json::Val(false);
+    } else if (EatLiteral(parser, "null", 4)) {
+        *out_val = Json::Val();
     } else {
-        // invalid root json value
-        this->parse_error = String(allocator, "Json document did not start with an object or array");
+        LOG_ERROR("Invalid json identifier starting with '%c'", c);
+        return "Invalid identifier";
     }
+    return nullptr;
 }
 
-static Array<Token>
-Tokenize(Allocator* allocator, const char* str, size_t str_size, const char** err_str)
+Json::Document::~Document()
 {
-    assert(err_str);
-    assert(str);
-    assert(str_size > 0);
-    Array<Token> tokens(allocator);
-
-    const uint8_t* it = (uint8_t*)str;
-    const uint8_t* end_it = (uint8_t*)str + str_size - 1;
+    while (_blocks) {
+        Block* next = _blocks->next;
+        allocator->Deallocate(_blocks);
+        _blocks = next;
+    }
+}
 
-    while (it <= end_it) {
-        it = Utils::EatWhitespaces(it, end_it);
-        if (it > end_it) {
-            continue;
+void*
+Json::Document::AllocateBlock(size_t size, size_t alignment)
+{
+    uint8_t* ptr = (uint8_t*)AlignForward((uintptr_t)_cursor, alignment);
+    if (!_cursor || ptr + size > _end) {
+        // Every block is twice as big as the previous one, up to kMaxBlockSize. Bigger requests
+        // get a block of their own size.
+        size_t block_size = _blocks ? HAN_MIN(_blocks->size * 2, kMaxBlockSize) : kMinBlockSize;
+        block_size = HAN_MAX(block_size, sizeof(Block) + size + alignment);
+        Block* block = (Block*)allocator->Allocate(block_size, alignof(Block));
+        if (!block) {
+            return nullptr;
         }
+        block->next = _blocks;
+        block->size = block_size;
+        _blocks = block;
+        _cursor = (uint8_t*)(block + 1);
+        _end = (uint8_t*)block + block_size;
+        ptr = (uint8_t*)AlignForward((uintptr_t)_cursor, alignment);
+    }
+    _cursor = ptr + size;
+    return ptr;
+}
 
-        if (*it == '{') {
-            Token tk(TokenType_OpenCurlyBraces);
-            tokens.PushBack(tk);
-            ++it;
-        } else if (*it == '}') {
-            Token tk(TokenType_CloseCurlyBraces);
-            tokens.PushBack(tk);
-            ++it;
-        } else if (*it == '[') {
-            Token tk(TokenType_OpenBrackets);
-            tokens.PushBack(tk);
-            ++it;
-        } else if (*it == ']') {
-            Token tk(TokenType_CloseBrackets);
-            tokens.PushBack(tk);
-            ++it;
-        } else if (*it == ',') {
-            Token tk(TokenType_Comma);
-            tokens.PushBack(tk);
-            ++it;
-        } else if (*it == ':') {
-            Token tk(TokenType_Colon);
-            tokens.PushBack(tk);
-            ++it;
-        } else if (*it == '"') {
-            ++it;
-            const uint8_t *last_it = Utils::EatUntil('"' , it, end_it);
-            ++last_it;
-            if (last_it > end_it) {
-                *err_str = "string does not end with a double quote";
-                return tokens;
-            }
-            Token tk(TokenType_String, it, (size_t)(last_it - 1 - it));
-            tokens.PushBack(std::move(tk));
-            it = last_it;
-        } else if (std::isdigit(*it) || *it == '-') {
-            // Parse until the last number
-            const uint8_t *last_it = Utils::EatWhile(static_cast<int(*)(int)>(std::isdigit), it + 1, end_it);
-
-            bool real = false;
-            if (*last_it == '.') {
-                // Number is a float, thus we have to take into account the fractional part
-                ++last_it;
-                last_it = Utils::EatWhile(static_cast<int(*)(int)>(std::isdigit), last_it, end_it);
-                real = true;
-            }
-
-			if (*last_it == 'e') {
-				// If the number is in exponential notation, we parse it as well.
-                ++last_it;
-				if (*last_it == '-') ++last_it;
-                last_it = Utils::EatWhile(static_cast<int(*)(int)>(std::isdigit), last_it, end_it);
-                real = true;
-			}
-            
-            Token tk(real ? TokenType_Real : TokenType_Integer, it, (size_t)(last_it - it));
-            tokens.PushBack(std::move(tk));
-            it = last_it;
-        } else {
-            // if this branch is executed it means either a boolean or a null
-            const uint8_t *last_it = Utils::EatUntil(',', it, end_it);
+void
+Json::Document::Parse(const char* json_str)
+{
+    assert(json_str);
+    Parse((const uint8_t*)json_str, strlen(json_str));
+}
 
-            if (last_it > end_it) {
-                *err_str = "value was not ended by a double quote or a comma";
-                return tokens;
-            }
+void
+Json::Document::Parse(const uint8_t* data, size_t size)
+{
+    assert(allocator != nullptr);
+    assert(data != nullptr);
+    assert(size > 0);
 
-            assert(last_it - it != 0);
+    uint8_t* text = (uint8_t*)AllocateBlock(size, 1);
+    if (!text) {
+        this->parse_error = String(allocator, kOutOfMemoryError);
+        return;
+    }
+    memcpy(text, data, size);
+    ParseInSitu(text, size);
+}
 
-            Token tk(TokenType_Null, it, (size_t)(last_it - it));
 
-            if (tk.str == "null") {
-                tk.type = TokenType_Null;
-            } else if (tk.str == "true" || tk.str == "false") {
-                tk.type = TokenType_Boolean;
-            } else {
-                LOG_ERROR("Invalid json identifier: %.*s", (int)tk.str.len, tk.str.data);
-                *err_str = "Invalid identifier";
-            }
+void
+Json::Document::ParseInSitu(const uint8_t* data, size_t size)
+{
+    assert(allocator != nullptr);
+    assert(data != nullptr);
+    assert(size > 0);
 
-            tokens.PushBack(std::move(tk));
+    Parser parser = {this, data, data + size, 0, Array<Val>(allocator), Array<Member>(allocator)};
+    EatWhitespaces(&parser);
+    if (parser.it >= parser.end || (*parser.it != '{' && *parser.it != '[')) {
+        // invalid root json value
+        this->parse_error = String(allocator, "Json document did not start with an object or array");
+        return;
+    }
 
-            it = last_it;
+    Val root;
+    const char* err_str = ParseValue(&parser, &root);
+    if (!err_str) {
+        EatWhitespaces(&parser);
+        if (parser.it != parser.end) {
+            err_str = "Unexpected characters after the end of the json document";
         }
     }
 
-    assert(it == end_it + 1);
-    *err_str = nullptr;
-    return tokens;
+    if (err_str) {
+        this->parse_error = String(allocator, err_str);
+    } else {
+        root_val = root;
+    }
 }
 
 //-----------------------------------------
 // Pretty printing
 //-----------------------------------------
 
-static void PrintObject(String* str, const RobinHashMap<String, Json::Val>& obj, int indent_level);
-static void PrintArray(String* str, const Array<Json::Val>& array, int indent_level);
+static void PrintObject(String* str, const Json::Object& obj, int indent_level);
+static void PrintArray(String* str, const Json::ArrayView& array, int indent_level);
 static void PrintVal(String* str, const Json::Val& val, int indent_level);
 
 static void
@@ -480,7 +486,7 @@ PrintBoolean(String* str, bool b)
 }
 
 static void
-PrintString(String* str, const String& str_to_print)
+PrintString(String* str, StringView str_to_print)
 {
     assert(str);
     str->Append('"');
@@ -507,16 +513,16 @@ PrintInteger(String* str, int64_t integer)
 }
 
 static void
-PrintObject(String* str, const RobinHashMap<String, Json::Val>& obj, int indent_level)
+PrintObject(String* str, const Json::Object& obj, int indent_level)
 {
     assert(str);
     str->Append("{\n");
-    for (RobinHashMap<String, Json::Val>::iterator it = obj.begin(); it != obj.end(); it++) {
+    for (uint32_t i = 0; i < obj.len; ++i) {
         PrintIndent(str, indent_level);
-        PrintString(str, (*it).key);
+        PrintString(str, obj.members[i].key);
         str->Append(": ");
-        PrintVal(str, (*it).val, indent_level);
-        if (it + 1 != obj.end()) {
+        PrintVal(str, obj.members[i].val, indent_level);
+        if (i != obj.len - 1) {
             str->Append(",\n");
         } else {
             str->Append('\n');
@@ -527,7 +533,7 @@ PrintObject(String* str, const RobinHashMap<String, Json::Val>& obj, int indent_
 }
 
 static void
-PrintArray(String* str, const Array<Json::Val>& array, int indent_level)
+PrintArray(String* str, const Json::ArrayView& array, int indent_level)
 {
     assert(str);
     str->Append("[\n");
@@ -6,6 +6,7 @@
 
 void RenderModel(
     const Model& model,
+    const ResourceManager& resources,
     const Shader& shader,
     Vec3 position,
     Quaternion orientation,
@@ -25,13 +26,22 @@ void RenderModel(
 
     // Set the rotation component
     const Mat4 object_to_world_matrix = model_matrix * orientation.ToMat4();
-    shader.SetUniformMat4(SID("u_model"), object_to_world_matrix);
+    shader.SetUniformMat4("u_model"_sid, object_to_world_matrix);
+
+    for (MeshHandle mesh_handle : model.meshes) {
+        const TriangleMesh* mesh = resources.GetMesh(mesh_handle);
+        if (!mesh) {
+            continue;
+        }
 
-    for (const auto& mesh : model.meshes) {
         for (const auto& submesh : mesh->sub_meshes) {
+            const Material* material = resources.GetMaterial(submesh.material);
+            if (!material) {
+                continue;
+            }
+
             submesh.vao->Bind();
-            //Material* material = g_debug_resource_manager->GetMaterial(SID("wall"));
-            submesh.material->Bind();
+            material->Bind(resources.textures);
             //if (submesh.material->diffuse_map) {
                 //glActiveTexture(GL_TEXTURE0 + 0);
                 //glBindTexture(GL_TEXTURE_2D, submesh.material->diffuse_map->handle);
@@ -67,6 +77,7 @@ void RenderModel(
 
 void
 RenderMesh(const TriangleMesh& mesh,
+           const ResourceManager& resources,
            const Shader& shader,
            Vec3 position,
            Quaternion orientation,
@@ -88,12 +99,16 @@ RenderMesh(const TriangleMesh& mesh,
 
     // Set the rotation component
     const Mat4 object_to_world_matrix = model_matrix * orientation.ToMat4();
-    shader.SetUniformMat4(SID("u_model"), object_to_world_matrix);
+    shader.SetUniformMat4("u_model"_sid, object_to_world_matrix);
 
     for (const auto& submesh : mesh.sub_meshes) {
+        const Material* material = resources.GetMaterial(submesh.material);
+        if (!material) {
+            continue;
+        }
+
         submesh.vao->Bind();
-        //Material* material = g_debug_resource_manager->GetMaterial(SID("wall"));
-        submesh.material->Bind();
+        material->Bind(resources.textures);
         //if (submesh.material->diffuse_map) {
             //glActiveTexture(GL_TEXTURE0 + 0);
             //glBindTexture(GL_TEXTURE_2D, submesh.material->diffuse_map->handle);
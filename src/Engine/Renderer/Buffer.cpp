@@ -34,25 +34,25 @@ BufferLayoutElement::BufferLayoutElement(BufferLayoutDataType data_type)
 VertexBuffer*
 VertexBuffer::Create(Allocator* allocator, const float* data, size_t size)
 {
-    return allocator->New<OpenGLVertexBuffer>(data, size);
+    return HAN_NEW(allocator, OpenGLVertexBuffer, data, size);
 }
 
 IndexBuffer*
 IndexBuffer::Create(Allocator* allocator, uint32_t* indices, size_t len)
 {
-    return allocator->New<OpenGLIndexBuffer>(indices, len);
+    return HAN_NEW(allocator, OpenGLIndexBuffer, indices, len);
 }
 
 IndexBuffer*
 IndexBuffer::Create(Allocator* allocator, uint16_t* indices, size_t len)
 {
-    return allocator->New<OpenGLIndexBuffer>(indices, len);
+    return HAN_NEW(allocator, OpenGLIndexBuffer, indices, len);
 }
 
 VertexArray*
 VertexArray::Create(Allocator* allocator)
 {
-    return allocator->New<OpenGLVertexArray>(allocator);
+    return HAN_NEW(allocator, OpenGLVertexArray, allocator);
 }
 
 
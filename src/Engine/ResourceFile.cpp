@@ -20,11 +20,11 @@ ResourceFile::ResourceFile(Allocator* allocator, Allocator* scratch_allocator)
 {}
 
 void
-ResourceFile::Create(const Sid& file_sid)
+ResourceFile::Create(const char* file)
 {
     auto resources_path = FileSystem::GetResourcesPath(_scratch_allocator);
     this->filepath.Push(resources_path);
-    this->filepath.Push(file_sid.GetStr());
+    this->filepath.Push(file);
     Parse();
 }
 
@@ -131,7 +131,7 @@ ResourceFile::Parse()
             tokens[t + 1].type == TokenType_Equals) {
             String key = std::move(tokens[t].str);
             if (Has(key)) {
-                LOG_ERROR("File already has the key %s", key.data);
+                LOG_ERROR("File already has the key %s", key.GetData());
                 return;
             }
 
@@ -141,18 +141,18 @@ ResourceFile::Parse()
                 // logger.log("adding entry ", key);
                 // logger.log("value ", val);
 
-                auto string_val = _allocator->New<StringVal>(std::move(val));
+                auto string_val = HAN_NEW(_allocator, StringVal, std::move(val));
                 _entries.Add(std::move(key), std::move(string_val));
 
                 t += 4; // four tokens were recognized
             } else if (tokens[t + 2].type == TokenType_OpenBracket) {
                 t += 3;
 
-                auto array_val = _allocator->New<ArrayVal>();
+                auto array_val = HAN_NEW(_allocator, ArrayVal);
 
                 while (t < tokens.len) {
                     if (tokens[t].type == TokenType_Identifier) {
-                        auto new_val = _allocator->New<StringVal>(std::move(tokens[t].str));
+                        auto new_val = HAN_NEW(_allocator, StringVal, std::move(tokens[t].str));
                         array_val->vals.PushBack(std::move(new_val));
 
                         if (loops_left(t, tokens) >= 2 &&
@@ -177,10 +177,10 @@ ResourceFile::Parse()
             } else if (tokens[t + 2].type == TokenType_Integer && tokens[t + 3].type == TokenType_Semicolon) {
                 const String& int_str = tokens[t + 2].str;
                 int32_t number;
-                bool ok = Utils::ParseInt32(int_str.data, &number);
+                bool ok = Utils::ParseInt32(int_str.GetData(), &number);
                 assert(ok && "should be able to parse a number");
 
-                auto int_val = _allocator->New<IntVal>(number);
+                auto int_val = HAN_NEW(_allocator, IntVal, number);
                 _entries.Add(std::move(key), std::move(int_val));
 
                 t += 4; // four tokens were recognized
@@ -20,10 +20,10 @@ static constexpr const char* kMtlFileKey = "mtl_file";
 static constexpr const char* kDiffuseTextureKey = "diffuse_texture";
 static constexpr const char* kNormalTextureKey = "normal_texture";
 
-static Texture* LoadTextureFromFile(Allocator* allocator,
-                                    Allocator* scratch_allocator,
-                                    const Sid& texture_sid,
-                                    int flags = LoadTextureFlags_None);
+static void LoadTextureFromFile(Texture* texture,
+                                Allocator* scratch_allocator,
+                                const char* texture_file,
+                                int flags = LoadTextureFlags_None);
 
 void
 ResourceManager::Create()
@@ -34,36 +34,34 @@ ResourceManager::Create()
 void
 ResourceManager::Destroy()
 {
-    assert(materials.allocator != nullptr);
-    for (auto& el : meshes) {
-        allocator->Delete(el.val);
-    }
+    assert(allocator != nullptr);
+    meshes.Clear();
+    mesh_handles.Clear();
 
-    for (auto& el : materials) {
-        allocator->Delete(el.val);
-    }
+    materials.Clear();
+    material_handles.Clear();
 
-    for (auto& el : textures) {
-        el.val->Destroy();
-        allocator->Delete(el.val);
+    for (auto& texture : textures) {
+        texture.Destroy();
     }
+    textures.Clear();
+    texture_handles.Clear();
 
     for (auto& el : shaders) {
         allocator->Delete(el.val);
     }
+    shaders.Clear();
 
     allocator = nullptr;
     scratch_allocator = nullptr;
 }
 
 Model
-ResourceManager::LoadModel(const Sid& model_file)
+ResourceManager::LoadModel(const char* model_file)
 {
-    LOG_INFO("Loading model %s", model_file.GetStr());
+    LOG_INFO("Loading model %s", model_file);
 
-    Path full_path(scratch_allocator);
-    full_path.Push(resources_path);
-    full_path.Push(model_file.GetStr());
+    StackAllocator::Scope scratch_scope(scratch_allocator);
 
     ResourceFile model_res(scratch_allocator, scratch_allocator);
     model_res.Create(model_file);
@@ -81,7 +79,7 @@ ResourceManager::LoadModel(const Sid& model_file)
         model_res.Destroy();
         return model;
     } else {
-        LOG_ERROR("Unsupported model type: %s", type->str.data);
+        LOG_ERROR("Unsupported model type: %s", type->str.GetData());
         assert(false);
         return Model(allocator);
     }
@@ -106,7 +104,7 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
     const auto* mtl_file_name = model_res.Get<ResourceFile::StringVal>(kMtlFileKey);
     Path mtl_file_path(scratch_allocator);
     mtl_file_path.Push(resources_path);
-    mtl_file_path.Push(mtl_file_name->str.data);
+    mtl_file_path.Push(mtl_file_name->str.GetData());
 
     FILE* mtl_file = fopen(mtl_file_path.data, "rb");
     assert(mtl_file);
@@ -122,16 +120,8 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
             // ignore
         } else if (sscanf(line, "newmtl %s", strbuf) == 1) {
             // new material
-            Sid material_name = SID(strbuf);
-
-            Material* new_material = allocator->New<Material>(allocator);
-            new_material->name = material_name;
-            new_material->shader = GetShader(SID("basic.glsl"));
-            materials.Add(material_name, new_material);
-
-            // FIXME: This is potentially dangerous, since if the hash table is rehashed the pointer
-            // will be invalid.
-            current_material = new_material;
+            // Only creating another material moves the current one.
+            current_material = GetMaterial(CreateMaterial(SID(strbuf), GetShader(SID("basic.glsl"))));
             assert(current_material);
         } else if (sscanf(line, "Ns %f", &val) == 1) {
             assert(current_material);
@@ -160,14 +150,12 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
             assert(current_material);
             // diffuse mapping. read diffuse texture from the resources folder
             String texture_path(scratch_allocator);
-            texture_path.Append(root_folder->str.data);
+            texture_path.Append(root_folder->str.GetData());
             texture_path.Append("/");
             texture_path.Append(strbuf);
 
-            Sid texture_sid = SID(texture_path.data);
-            LoadTexture(texture_sid, LoadTextureFlags_FlipVertically|LoadTextureFlags_LinearSpace);
-
-            current_material->AddValue(SID("u_input_texture"), MaterialValue(GetTexture(texture_sid)));
+            TextureHandle texture = LoadTexture(texture_path.GetData(), LoadTextureFlags_FlipVertically|LoadTextureFlags_LinearSpace);
+            current_material->AddValue("u_input_texture"_sid, MaterialValue(texture));
         } else if (sscanf(line, "map_Bump %s", strbuf) == 1) {
             assert(current_material);
             // normal mapping
@@ -187,17 +175,41 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
     const auto* obj_file_name = model_res.Get<ResourceFile::StringVal>(kObjFileKey);
     Path obj_file_path(scratch_allocator);
     obj_file_path.Push(resources_path);
-    obj_file_path.Push(obj_file_name->str.data);
+    obj_file_path.Push(obj_file_name->str.GetData());
 
     FILE* obj_file = fopen(obj_file_path.data, "rb");
     assert(obj_file);
 
-    TriangleMesh* mesh = allocator->New<TriangleMesh>(allocator);
+    // No other mesh is added while this one is filled, so the pointer stays valid.
+    const MeshHandle mesh_handle = CreateMesh(SID(obj_file_name->str.GetData()));
+    TriangleMesh* mesh = GetMesh(mesh_handle);
+
+    // Count the positions, uvs and faces first, so that every array is allocated only once.
+    size_t num_positions = 0;
+    size_t num_uvs = 0;
+    size_t num_faces = 0;
+    while (fgets(line, sizeof(line), obj_file) != nullptr) {
+        if (line[0] == 'v' && line[1] == ' ') {
+            ++num_positions;
+        } else if (line[0] == 'v' && line[1] == 't') {
+            ++num_uvs;
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            ++num_faces;
+        }
+    }
+    rewind(obj_file);
 
     // face is vertex, texture and normal indices
     Array<Vec3> temp_vertices(scratch_allocator);
     Array<Vec2> temp_uvs(scratch_allocator);
     Array<Vec3> temp_normals(scratch_allocator);
+    temp_vertices.Reserve(num_positions);
+    temp_uvs.Reserve(num_uvs);
+
+    // Every face gets its own three vertices.
+    mesh->vertices.Reserve(3 * num_faces);
+    mesh->uvs.Reserve(3 * num_faces);
+    mesh->indices.Reserve(3 * num_faces);
 
     SubMesh current_submesh = {};
 
@@ -241,14 +253,13 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
             }
 
             // specifies the current material
-            Sid material_name = SID(strbuf);
-            Material* mat = GetMaterial(material_name);
-            assert(mat);
+            MaterialHandle material = FindMaterial(SID(strbuf));
+            assert(material.IsValid());
             assert((current_submesh.start_index + current_submesh.num_indices) == mesh->indices.len);
 
             current_submesh.start_index = (int32_t)(current_submesh.start_index + current_submesh.num_indices);
             current_submesh.num_indices = 0;
-            current_submesh.material = mat;
+            current_submesh.material = material;
         } else if (sscanf(line, "mtllib %s", strbuf) == 1) {
             // ignore
         } else if (sscanf(line, "f %d/%d/%d %d/%d/%d %d/%d/%d",
@@ -286,8 +297,9 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
 
     // Build the buffer that is going to be uploaded to the GPU.
     Array<OpenGL::Vertex_PT> buffer(scratch_allocator);
+    buffer.Reserve(mesh->vertices.len);
     for (size_t i = 0; i < mesh->vertices.len; ++i) {
-        buffer.PushBack(OpenGL::Vertex_PT(mesh->vertices[i], mesh->uvs[i]));
+        buffer.EmplaceBack(mesh->vertices[i], mesh->uvs[i]);
     }
 
     auto vbo = VertexBuffer::Create(mesh->allocator, (float*)buffer.data, buffer.len * sizeof(OpenGL::Vertex_PT));
@@ -298,10 +310,10 @@ ResourceManager::LoadObjModel(const ResourceFile& model_res)
 
     auto ibo = IndexBuffer::Create(mesh->allocator, mesh->indices.data, mesh->indices.len);
 
-    model.meshes.PushBack(mesh);
+    model.meshes.PushBack(mesh_handle);
 
     // HACK
-    for (auto& submesh : model.meshes[0]->sub_meshes) {
+    for (auto& submesh : mesh->sub_meshes) {
         submesh.vao = VertexArray::Create(mesh->allocator);
         submesh.vao->SetIndexBuffer(ibo);
         submesh.vao->SetVertexBuffer(vbo);
@@ -314,40 +326,151 @@ ResourceManager::LoadGltfModel(const ResourceFile& res_file)
 {
     auto gltf_file = res_file.Get<ResourceFile::StringVal>(kGltfFileKey);
     Path gltf_file_path = FileSystem::GetResourcesPath(scratch_allocator);
-    gltf_file_path.Push(gltf_file->str.data);
+    gltf_file_path.Push(gltf_file->str.GetData());
 
     Model model = ImportGltf2Model(allocator, scratch_allocator, gltf_file_path, this);
 
     return model;
 }
 
-Texture*
-ResourceManager::LoadTexture(const Sid& texture_sid, int flags)
+TextureHandle
+ResourceManager::LoadTexture(const char* texture_file, int flags)
 {
-    Texture** texture;
-    if (texture = textures.Find(texture_sid)) {
-        return *texture;
+    const Sid texture_sid = SID(texture_file);
+    const TextureHandle* handle = texture_handles.Find(texture_sid);
+    if (handle) {
+        return *handle;
     } else {
-        LOG_DEBUG("Loading texture for SID %s", texture_sid.GetStr());
-        Texture* new_texture = LoadTextureFromFile(allocator, scratch_allocator, texture_sid, flags);
-        textures.Add(texture_sid, new_texture);
-        return new_texture;
+        LOG_DEBUG("Loading texture %s", texture_file);
+        StackAllocator::Scope scratch_scope(scratch_allocator);
+        Texture texture(allocator, texture_sid);
+        LoadTextureFromFile(&texture, scratch_allocator, texture_file, flags);
+        TextureHandle new_handle = textures.Add(std::move(texture));
+        texture_handles.Add(texture_sid, new_handle);
+        return new_handle;
+    }
+}
+
+bool
+ResourceManager::UnloadTexture(const Sid& texture_sid)
+{
+    TextureHandle* handle = texture_handles.Find(texture_sid);
+    if (!handle) {
+        return false;
+    }
+
+    LOG_DEBUG("Unloading texture %s", texture_sid.GetStrOr("<unknown>"));
+    textures.Get(*handle)->Destroy();
+    textures.Remove(*handle);
+    texture_handles.Remove(texture_sid);
+    return true;
+}
+
+MaterialHandle
+ResourceManager::CreateMaterial(const Sid& material_name, Shader* shader)
+{
+    UnloadMaterial(material_name);
+
+    MaterialHandle handle = materials.Add(allocator);
+    Material* material = materials.Get(handle);
+    material->name = material_name;
+    material->shader = shader;
+    material_handles.Add(material_name, handle);
+    return handle;
+}
+
+bool
+ResourceManager::UnloadMaterial(const Sid& material_name)
+{
+    const MaterialHandle* handle = material_handles.Find(material_name);
+    if (!handle) {
+        return false;
     }
+
+    LOG_DEBUG("Unloading material %s", material_name.GetStrOr("<unknown>"));
+    materials.Remove(*handle);
+    material_handles.Remove(material_name);
+    return true;
+}
+
+MeshHandle
+ResourceManager::CreateMesh(const Sid& mesh_name)
+{
+    UnloadMesh(mesh_name);
+
+    MeshHandle handle = meshes.Add(allocator);
+    meshes.Get(handle)->name = mesh_name;
+    mesh_handles.Add(mesh_name, handle);
+    return handle;
+}
+
+bool
+ResourceManager::UnloadMesh(const Sid& mesh_name)
+{
+    const MeshHandle* handle = mesh_handles.Find(mesh_name);
+    if (!handle) {
+        return false;
+    }
+
+    LOG_DEBUG("Unloading mesh %s", mesh_name.GetStrOr("<unknown>"));
+    meshes.Remove(*handle);
+    mesh_handles.Remove(mesh_name);
+    return true;
 }
 
 void
-ResourceManager::LoadShader(const Sid& shader_sid)
+ResourceManager::UnloadModel(Model* model)
 {
+    assert(model);
+    for (MeshHandle handle : model->meshes) {
+        const TriangleMesh* mesh = meshes.Get(handle);
+        if (!mesh) {
+            continue;
+        }
+
+        // Another mesh could have been registered under the same name since.
+        const MeshHandle* registered = mesh_handles.Find(mesh->name);
+        if (registered && *registered == handle) {
+            mesh_handles.Remove(mesh->name);
+        }
+        meshes.Remove(handle);
+    }
+    model->meshes.Clear();
+}
+
+bool
+ResourceManager::UnloadShader(const Sid& shader_sid)
+{
+    Shader** shader = shaders.Find(shader_sid);
+    if (!shader) {
+        return false;
+    }
+
+    LOG_DEBUG("Unloading shader %s", shader_sid.GetStrOr("<unknown>"));
+    allocator->Delete(*shader);
+    shaders.Remove(shader_sid);
+    return true;
+}
+
+void
+ResourceManager::LoadShader(const char* shader_file)
+{
+    if (shaders.Find(SID(shader_file))) {
+        return;
+    }
+
+    StackAllocator::Scope scratch_scope(scratch_allocator);
+
     Path full_path(scratch_allocator);
     full_path.Push(resources_path);
     full_path.Push("shaders");
-    full_path.Push(shader_sid.GetStr());
+    full_path.Push(shader_file);
 
-    LOG_DEBUG("Making shader program for %s", shader_sid.GetStr());
+    LOG_DEBUG("Making shader program for %s", shader_file);
 
-    Shader* shader = allocator->New<Shader>(allocator);
+    Shader* shader = HAN_NEW(allocator, Shader, allocator);
     assert(shader);
-    shader->name.Append(shader_sid.GetStr());
+    shader->name.Append(shader_file);
 
     GLuint vertex_shader = 0, fragment_shader = 0;
     GLchar info[512] = {};
@@ -363,13 +486,14 @@ ResourceManager::LoadShader(const Sid& shader_sid)
         size_t file_size = ftell(fp);
         fseek(fp, 0, SEEK_SET);
 
-        // allocate enough memory
-        shader_string = (char*)allocator->Allocate(file_size);
+        // allocate enough memory, including the null terminator expected by glShaderSource
+        shader_string = (char*)scratch_allocator->Allocate(file_size + 1, alignof(char));
         assert(shader_string && "there should be enough memory here");
 
         // read the file into the buffer
         size_t nread = fread(shader_string, 1, file_size, fp);
         assert(nread == file_size && "the correct amount of bytes should be read");
+        shader_string[file_size] = '\0';
 
         fclose(fp);
     }
@@ -428,13 +552,15 @@ ResourceManager::LoadShader(const Sid& shader_sid)
     goto ok;
 
 error_cleanup:
-    LOG_ERROR("Failed to load shader %s", shader_sid.GetStr());
+    LOG_ERROR("Failed to load shader %s", shader_file);
     allocator->Delete(shader);
+    // It was already freed, so the shader is registered as null instead.
+    shader = nullptr;
 
 ok:
     glDeleteShader(vertex_shader);
     glDeleteShader(fragment_shader);
-    shaders.Add(shader_sid, shader);
+    shaders.Add(SID(shader_file), shader);
 }
 
 
@@ -442,27 +568,28 @@ ok:
 // Helper functions
 //================================================================
 
-static Texture*
-LoadTextureFromFile(Allocator* allocator,
+static void
+LoadTextureFromFile(Texture* texture,
                     Allocator* scratch_allocator,
-                    const Sid& texture_sid,
+                    const char* texture_file,
                     int flags)
 {
-    assert(allocator);
+    assert(texture);
     assert(scratch_allocator);
 
     Path resources_path = FileSystem::GetResourcesPath(scratch_allocator);
 
     Path full_asset_path(scratch_allocator);
     full_asset_path.Push(resources_path);
-    full_asset_path.Push(texture_sid.GetStr());
-
-    Texture* texture = allocator->New<Texture>(allocator, texture_sid);
+    full_asset_path.Push(texture_file);
 
     size_t texture_buffer_size;
     uint8_t* texture_buffer =
-        FileSystem::LoadFileToMemory(allocator, full_asset_path, &texture_buffer_size);
-    assert(texture_buffer);
+        FileSystem::LoadFileToMemory(scratch_allocator, full_asset_path, &texture_buffer_size);
+    if (!texture_buffer) {
+        LOG_ERROR("Failed to read texture at %s", full_asset_path.data);
+        return;
+    }
 
     // memory was read, now load it into an opengl buffer
 
@@ -527,8 +654,7 @@ LoadTextureFromFile(Allocator* allocator,
     free(data);
 
 cleanup_texture_buffer:
-    allocator->Deallocate(texture_buffer);
+    scratch_allocator->Deallocate(texture_buffer);
 
     texture->loaded = true;
-    return texture;
 }
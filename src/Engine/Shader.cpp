@@ -54,6 +54,20 @@ Shader::AddUniform(const char* loc)
     location_cache.Add(SID(loc), location);
 }
 
+void
+Shader::RemoveUniform(Sid loc)
+{
+    if (!location_cache.Remove(loc)) {
+        LOG_WARN("Uniform %s was not added to the shader", loc.GetStrOr("<unknown>"));
+    }
+}
+
+void
+Shader::ClearUniforms()
+{
+    location_cache.Clear();
+}
+
 void
 Shader::SetUniformMat4(Sid loc, const Mat4& mat) const
 {
@@ -1,7 +1,7 @@
 #include "Han/Sid.hpp"
 
+#if HAN_SID_DATABASE
 // global instance of the debug sid database
-// TODO: consider removing this databse in release builds.
 SidDatabase* g_debug_sid_database;
 
 void SidDatabase::Initialize(Allocator* allocator)
@@ -16,4 +16,83 @@ void SidDatabase::Terminate()
     g_debug_sid_database->Destroy();
     allocator->Delete(g_debug_sid_database);
 }
+#endif
 
+SidDatabase::SidDatabase(Allocator* allocator)
+    : allocator(allocator)
+{
+    for (Shard& shard : _shards) {
+        shard.strings = RobinHashMap<uint64_t, const char*>(allocator, kDatabaseSize / kNumShards);
+        shard.pool = StringPool(allocator, kPageSize);
+    }
+}
+
+void
+SidDatabase::Destroy()
+{
+    for (Shard& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.strings.Clear();
+        shard.pool.Clear();
+    }
+    allocator = nullptr;
+}
+
+size_t
+SidDatabase::GetLen() const
+{
+    size_t len = 0;
+    for (const Shard& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        len += shard.strings.num_elements;
+    }
+    return len;
+}
+
+size_t
+SidDatabase::GetBytesUsed() const
+{
+    size_t bytes = 0;
+    for (const Shard& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bytes += shard.pool.GetBytesUsed();
+    }
+    return bytes;
+}
+
+void
+SidDatabase::AddHash(uint64_t hash, const char* str)
+{
+    assert(allocator);
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const char** entry = shard.strings.Find(hash);
+    if (entry) {
+        if (strcmp(*entry, str) != 0) {
+            // ignore, since the string already exists
+            LOG_ERROR("String %s has the same hash as already interned string %s", str, *entry);
+            assert(false);
+        }
+        return;
+    }
+
+    shard.strings.Add(hash, shard.pool.Add(str).data);
+}
+
+void
+SidDatabase::RemoveHash(uint64_t hash)
+{
+    assert(allocator);
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.strings.Remove(hash);
+}
+
+const char*
+SidDatabase::FindStr(uint64_t hash) const
+{
+    const Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const char* const* str = shard.strings.Find(hash);
+    return str ? *str : nullptr;
+}
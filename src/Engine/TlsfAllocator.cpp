@@ -0,0 +1,360 @@
+#include "Han/TlsfAllocator.hpp"
+#include "Han/Logger.hpp"
+#include "Han/Utils.hpp"
+
+#if COMPILER_MSC
+#include <intrin.h>
+#endif
+
+// Returns the index of the lowest set bit. The value should not be 0.
+static int
+FindFirstSet(uint32_t value)
+{
+#if COMPILER_MSC
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+// Returns the index of the highest set bit. The value should not be 0.
+static int
+FindLastSet(size_t value)
+{
+#if COMPILER_MSC
+    unsigned long index;
+    _BitScanReverse64(&index, (unsigned long long)value);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll((unsigned long long)value);
+#endif
+}
+
+TlsfAllocator::TlsfAllocator()
+    : _mem(nullptr)
+    , _size(0)
+    , _bytes_allocated(0)
+    , _name(nullptr)
+    , _first_block(nullptr)
+    , _first_level_bitmap(0)
+    , _second_level_bitmaps{}
+    , _free_lists{}
+{}
+
+TlsfAllocator::TlsfAllocator(const char* name, const Memory& mem)
+    : TlsfAllocator(name, mem.ptr, mem.size)
+{}
+
+TlsfAllocator::TlsfAllocator(const char* name, void* mem, size_t size)
+    : _mem(mem)
+    , _size(size)
+    , _bytes_allocated(0)
+    , _name(name)
+    , _first_block(nullptr)
+    , _first_level_bitmap(0)
+    , _second_level_bitmaps{}
+    , _free_lists{}
+{
+    assert(_mem && "should be instantiated with memory");
+    assert(_name && "allocator should have a name");
+
+    const uintptr_t start = AlignForward((uintptr_t)mem, kBlockAlignment);
+    const size_t padding = start - (uintptr_t)mem;
+    // The pool is made of one big free block, followed by an empty block that is always in use,
+    // so that the last block never tries to merge with the memory that comes after the pool.
+    assert(size >= padding + 2 * kBlockOverhead + kMinBlockSize && "allocator should have enough memory");
+    const size_t pool_size = (size - padding - 2 * kBlockOverhead) & ~(kBlockAlignment - 1);
+    assert(pool_size < kMaxBlockSize && "pool is too big");
+
+    _first_block = (BlockHeader*)start;
+    _first_block->prev_physical = nullptr;
+    _first_block->size_and_flags = pool_size;
+    _first_block->SetFree(true);
+
+    BlockHeader* sentinel = _first_block->GetNextPhysical();
+    sentinel->prev_physical = _first_block;
+    sentinel->size_and_flags = 0;
+
+    InsertFreeBlock(_first_block);
+}
+
+void*
+TlsfAllocator::DoAllocate(size_t size, size_t alignment)
+{
+    ASSERT(_mem, "Allocator should be initialized");
+    ASSERT(IsPowerOfTwo(alignment), "Alignment should be a power of two");
+
+    const size_t adjusted_size = AlignForward(HAN_MAX(size, kMinBlockSize), kBlockAlignment);
+
+    // Payloads are always aligned to kBlockAlignment. For bigger alignments we look for a block that
+    // is big enough to leave a free block in front of the aligned payload.
+    const size_t search_size = alignment <= kBlockAlignment
+        ? adjusted_size
+        : adjusted_size + alignment + sizeof(BlockHeader);
+
+    BlockHeader* block = nullptr;
+    if (search_size < kMaxBlockSize) {
+        int fl, sl;
+        MappingSearch(search_size, &fl, &sl);
+        if (fl < kFirstLevelCount) {
+            block = FindSuitableBlock(&fl, &sl);
+            if (block) {
+                RemoveFreeBlock(block, fl, sl);
+            }
+        }
+    }
+
+    if (!block) {
+        LOG_WARN("Cannot allocate %s memory in %s allocator (%s free)",
+                 Utils::GetPrettySize(size).GetData(),
+                 _name,
+                 Utils::GetPrettySize(_size - _bytes_allocated).GetData());
+        return nullptr;
+    }
+
+    if (alignment > kBlockAlignment) {
+        const uintptr_t payload = (uintptr_t)block->GetPayload();
+        uintptr_t aligned = AlignForward(payload, alignment);
+        if (aligned != payload && aligned - payload < sizeof(BlockHeader)) {
+            // The gap is too small to hold a free block.
+            aligned = AlignForward(payload + sizeof(BlockHeader), alignment);
+        }
+
+        const size_t gap = aligned - payload;
+        if (gap > 0) {
+            BlockHeader* aligned_block = (BlockHeader*)(aligned - kBlockOverhead);
+            aligned_block->prev_physical = block;
+            aligned_block->size_and_flags = block->GetSize() - gap;
+            aligned_block->SetFree(true);
+            aligned_block->GetNextPhysical()->prev_physical = aligned_block;
+
+            // The previous block of a free block is never free, so there is nothing to merge with.
+            block->SetSize(gap - kBlockOverhead);
+            InsertFreeBlock(block);
+            block = aligned_block;
+        }
+    }
+
+    if (block->GetSize() >= adjusted_size + sizeof(BlockHeader)) {
+        BlockHeader* remainder = Split(block, adjusted_size);
+        InsertFreeBlock(remainder);
+    }
+
+    block->SetFree(false);
+    _bytes_allocated += block->GetSize();
+
+    return block->GetPayload();
+}
+
+void
+TlsfAllocator::DoDeallocate(void* ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    ASSERT((uint8_t*)ptr >= (uint8_t*)_mem && (uint8_t*)ptr < (uint8_t*)_mem + _size,
+           "Pointer should belong to this allocator");
+
+    BlockHeader* block = BlockHeader::FromPayload(ptr);
+    ASSERT(!block->IsFree(), "Block should not be freed twice");
+
+    _bytes_allocated -= block->GetSize();
+    block->SetFree(true);
+
+    block = MergeWithPrevious(block);
+    block = MergeWithNext(block);
+    InsertFreeBlock(block);
+}
+
+bool
+TlsfAllocator::DoTryExtend(void* ptr, size_t old_size, size_t new_size)
+{
+    (void)old_size;
+    ASSERT((uint8_t*)ptr >= (uint8_t*)_mem && (uint8_t*)ptr < (uint8_t*)_mem + _size,
+           "Pointer should belong to this allocator");
+
+    BlockHeader* block = BlockHeader::FromPayload(ptr);
+    ASSERT(!block->IsFree(), "Block should be in use");
+
+    const size_t adjusted_size = AlignForward(HAN_MAX(new_size, kMinBlockSize), kBlockAlignment);
+    const size_t block_size = block->GetSize();
+
+    if (adjusted_size > block_size) {
+        // The block can only grow by taking the free block that follows it.
+        BlockHeader* next = block->GetNextPhysical();
+        if (!next->IsFree() || block_size + kBlockOverhead + next->GetSize() < adjusted_size) {
+            return false;
+        }
+
+        RemoveFreeBlock(next);
+        block->SetSize(block_size + kBlockOverhead + next->GetSize());
+        block->GetNextPhysical()->prev_physical = block;
+    }
+
+    // Give back what is not needed, merged with the next block when it is free.
+    if (block->GetSize() >= adjusted_size + sizeof(BlockHeader)) {
+        BlockHeader* remainder = Split(block, adjusted_size);
+        remainder = MergeWithNext(remainder);
+        InsertFreeBlock(remainder);
+    }
+
+    _bytes_allocated = _bytes_allocated - block_size + block->GetSize();
+    return true;
+}
+
+TlsfAllocator::Stats
+TlsfAllocator::GetStats() const
+{
+    Stats stats = {};
+    if (!_first_block) {
+        return stats;
+    }
+
+    for (BlockHeader* block = _first_block; !block->IsLast(); block = block->GetNextPhysical()) {
+        if (block->IsFree()) {
+            stats.free_bytes += block->GetSize();
+            stats.num_free_blocks++;
+            stats.largest_free_block = HAN_MAX(stats.largest_free_block, block->GetSize());
+        } else {
+            stats.num_used_blocks++;
+        }
+    }
+
+    stats.fragmentation = stats.free_bytes > 0
+        ? 1.0f - (float)stats.largest_free_block / (float)stats.free_bytes
+        : 0.0f;
+
+    return stats;
+}
+
+void
+TlsfAllocator::MappingInsert(size_t size, int* fl, int* sl)
+{
+    if (size < kSmallBlockSize) {
+        *fl = 0;
+        *sl = (int)(size / (kSmallBlockSize / kSecondLevelCount));
+    } else {
+        const int last_bit = FindLastSet(size);
+        *sl = (int)(size >> (last_bit - kSecondLevelCountLog2)) ^ kSecondLevelCount;
+        *fl = last_bit - (kFirstLevelShift - 1);
+    }
+}
+
+void
+TlsfAllocator::MappingSearch(size_t size, int* fl, int* sl)
+{
+    // Round the size up to the next list, so that any block of that list is big enough.
+    if (size >= kSmallBlockSize) {
+        size += ((size_t)1 << (FindLastSet(size) - kSecondLevelCountLog2)) - 1;
+    }
+    MappingInsert(size, fl, sl);
+}
+
+TlsfAllocator::BlockHeader*
+TlsfAllocator::FindSuitableBlock(int* fl, int* sl)
+{
+    uint32_t sl_map = _second_level_bitmaps[*fl] & (~0u << *sl);
+    if (!sl_map) {
+        // No block in this first level list, look for the next non empty one.
+        const uint32_t fl_map = _first_level_bitmap & (~0u << (*fl + 1));
+        if (!fl_map) {
+            return nullptr;
+        }
+        *fl = FindFirstSet(fl_map);
+        sl_map = _second_level_bitmaps[*fl];
+    }
+
+    *sl = FindFirstSet(sl_map);
+    return _free_lists[*fl][*sl];
+}
+
+void
+TlsfAllocator::InsertFreeBlock(BlockHeader* block)
+{
+    int fl, sl;
+    MappingInsert(block->GetSize(), &fl, &sl);
+
+    BlockHeader* head = _free_lists[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head) {
+        head->prev_free = block;
+    }
+
+    _free_lists[fl][sl] = block;
+    _first_level_bitmap |= 1u << fl;
+    _second_level_bitmaps[fl] |= 1u << sl;
+}
+
+void
+TlsfAllocator::RemoveFreeBlock(BlockHeader* block)
+{
+    int fl, sl;
+    MappingInsert(block->GetSize(), &fl, &sl);
+    RemoveFreeBlock(block, fl, sl);
+}
+
+void
+TlsfAllocator::RemoveFreeBlock(BlockHeader* block, int fl, int sl)
+{
+    if (block->prev_free) {
+        block->prev_free->next_free = block->next_free;
+    }
+    if (block->next_free) {
+        block->next_free->prev_free = block->prev_free;
+    }
+
+    if (_free_lists[fl][sl] == block) {
+        _free_lists[fl][sl] = block->next_free;
+        if (!block->next_free) {
+            _second_level_bitmaps[fl] &= ~(1u << sl);
+            if (!_second_level_bitmaps[fl]) {
+                _first_level_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+}
+
+TlsfAllocator::BlockHeader*
+TlsfAllocator::Split(BlockHeader* block, size_t size)
+{
+    BlockHeader* remainder = (BlockHeader*)((uint8_t*)block->GetPayload() + size);
+    remainder->prev_physical = block;
+    remainder->size_and_flags = block->GetSize() - size - kBlockOverhead;
+    remainder->SetFree(true);
+    remainder->GetNextPhysical()->prev_physical = remainder;
+
+    block->SetSize(size);
+    return remainder;
+}
+
+TlsfAllocator::BlockHeader*
+TlsfAllocator::MergeWithPrevious(BlockHeader* block)
+{
+    BlockHeader* prev = block->prev_physical;
+    if (!prev || !prev->IsFree()) {
+        return block;
+    }
+
+    RemoveFreeBlock(prev);
+    prev->SetSize(prev->GetSize() + kBlockOverhead + block->GetSize());
+    prev->GetNextPhysical()->prev_physical = prev;
+    return prev;
+}
+
+TlsfAllocator::BlockHeader*
+TlsfAllocator::MergeWithNext(BlockHeader* block)
+{
+    BlockHeader* next = block->GetNextPhysical();
+    if (!next->IsFree()) {
+        return block;
+    }
+
+    RemoveFreeBlock(next);
+    block->SetSize(block->GetSize() + kBlockOverhead + next->GetSize());
+    block->GetNextPhysical()->prev_physical = block;
+    return block;
+}
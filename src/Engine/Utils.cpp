@@ -51,8 +51,8 @@ Utils::ParseInt32(const uint8_t* data, size_t size, int32_t* res)
 
 	ASSERT(search < end, "Search should always be smaller than end");
     while (search < end) {
-		if (*search == '-') {
-			is_negative = true;
+		if (*search == '-' || *search == '+') {
+			is_negative = *search == '-';
 			++search;
 			++num_consumed;
 		} else if (isdigit(*search)) {
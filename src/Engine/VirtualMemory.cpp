@@ -0,0 +1,79 @@
+#include "Han/VirtualMemory.hpp"
+#include "Han/Core.hpp"
+#include "Han/Logger.hpp"
+
+#if OS_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+size_t
+VirtualMemory::GetPageSize()
+{
+    static size_t page_size = 0;
+    if (page_size == 0) {
+#if OS_WINDOWS
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        page_size = info.dwPageSize;
+#else
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    }
+    return page_size;
+}
+
+void*
+VirtualMemory::Reserve(size_t size)
+{
+#if OS_WINDOWS
+    void* ptr = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        ptr = nullptr;
+    }
+#endif
+    if (!ptr) {
+        LOG_ERROR("Failed to reserve %zu bytes of virtual memory", size);
+    }
+    return ptr;
+}
+
+bool
+VirtualMemory::Commit(void* ptr, size_t size)
+{
+#if OS_WINDOWS
+    bool committed = VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    bool committed = mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+    if (!committed) {
+        LOG_ERROR("Failed to commit %zu bytes of virtual memory", size);
+    }
+    return committed;
+}
+
+void
+VirtualMemory::Decommit(void* ptr, size_t size)
+{
+#if OS_WINDOWS
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+    madvise(ptr, size, MADV_DONTNEED);
+    mprotect(ptr, size, PROT_NONE);
+#endif
+}
+
+void
+VirtualMemory::Release(void* ptr, size_t size)
+{
+#if OS_WINDOWS
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif
+}